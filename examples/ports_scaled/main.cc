@@ -0,0 +1,259 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include <unistd.h>
+
+#include "reactor-cpp/reactor-cpp.hh"
+
+using namespace reactor;
+using namespace std::chrono_literals;
+
+// A scaled up version of the ports example. The topology is replicated a
+// given number of times, all reactions perform a configurable amount of
+// synthetic work, and the printers are replaced by sinks that do not write to
+// the console.
+
+namespace {
+
+Duration work{10us};
+std::atomic<unsigned long> executed_reactions{0};
+
+void synthetic_work() {
+  executed_reactions.fetch_add(1, std::memory_order_relaxed);
+  auto end = std::chrono::steady_clock::now() + work;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+}  // namespace
+
+class Trigger : public Reactor {
+ private:
+  Timer timer;
+
+  Reaction r_timer{"r_timer", 1, this, [this]() { on_timer(); }};
+
+ public:
+  Trigger(const std::string& name, Environment* env, Duration period)
+      : Reactor(name, env), timer{"timer", this, period, Duration::zero()} {}
+
+  Output<void> trigger{"trigger", this};
+
+  void assemble() override {
+    r_timer.declare_trigger(&timer);
+    r_timer.declare_antidependency(&trigger);
+  }
+
+  void on_timer() {
+    synthetic_work();
+    trigger.set();
+  }
+};
+
+class Counter : public Reactor {
+ private:
+  unsigned value{0};
+
+  Reaction r_trigger{"r_trigger", 1, this, [this]() { on_trigger(); }};
+
+ public:
+  Counter(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  Input<void> trigger{"trigger", this};
+  Output<int> count{"count", this};
+
+  void assemble() override {
+    r_trigger.declare_trigger(&trigger);
+    r_trigger.declare_antidependency(&count);
+  }
+
+  void on_trigger() {
+    synthetic_work();
+    value += 1;
+    count.set(value);
+  }
+};
+
+class Sink : public Reactor {
+ private:
+  Reaction r_value{"r_value", 1, this, [this]() { on_value(); }};
+
+ public:
+  Input<int> value{"value", this};
+  long checksum{0};
+
+  Sink(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  void assemble() override { r_value.declare_trigger(&value); }
+
+  void on_value() {
+    synthetic_work();
+    checksum += *value.get();
+  }
+};
+
+class Adder : public Reactor {
+ private:
+  Reaction r_add{"r_add", 1, this, [this]() { add(); }};
+
+ public:
+  Input<int> i1{"i1", this};
+  Input<int> i2{"i2", this};
+  Output<int> sum{"sum", this};
+
+  Adder(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  void assemble() override {
+    r_add.declare_trigger(&i1);
+    r_add.declare_trigger(&i2);
+    r_add.declare_antidependency(&sum);
+  }
+
+  void add() {
+    synthetic_work();
+    if (i1.is_present() && i2.is_present()) {
+      sum.set(*i1.get() + *i2.get());
+    }
+  }
+};
+
+class Timeout : public Reactor {
+ private:
+  Timer timer;
+
+  Reaction r_timer{"r_timer", 1, this,
+                   [this]() { environment()->sync_shutdown(); }};
+
+ public:
+  Timeout(Environment* env, Duration timeout)
+      : Reactor("Timeout", env)
+      , timer{"timer", this, Duration::zero(), timeout} {}
+
+  void assemble() override { r_timer.declare_trigger(&timer); }
+};
+
+struct Ports {
+  Trigger t1;
+  Counter c1;
+  Sink s1;
+  Trigger t2;
+  Counter c2;
+  Sink s2;
+  Adder add;
+  Sink s_add;
+
+  Ports(unsigned i, Environment* env, Duration period)
+      : t1{"t1_" + std::to_string(i), env, period}
+      , c1{"c1_" + std::to_string(i), env}
+      , s1{"s1_" + std::to_string(i), env}
+      , t2{"t2_" + std::to_string(i), env, 2 * period}
+      , c2{"c2_" + std::to_string(i), env}
+      , s2{"s2_" + std::to_string(i), env}
+      , add{"add_" + std::to_string(i), env}
+      , s_add{"s_add_" + std::to_string(i), env} {
+    t1.trigger.bind_to(&c1.trigger);
+    c1.count.bind_to(&s1.value);
+    t2.trigger.bind_to(&c2.trigger);
+    c2.count.bind_to(&s2.value);
+    c1.count.bind_to(&add.i1);
+    c2.count.bind_to(&add.i2);
+    add.sum.bind_to(&s_add.value);
+  }
+};
+
+// Parses a non-negative decimal number that fits into an unsigned int.
+bool parse_number(const char* arg, unsigned& value) {
+  char* end{nullptr};
+  errno = 0;
+  auto result = std::strtoul(arg, &end, 10);
+  if (arg[0] == '-' || end == arg || *end != '\0' || errno == ERANGE ||
+      result > std::numeric_limits<unsigned>::max()) {
+    return false;
+  }
+  value = static_cast<unsigned>(result);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  unsigned instances{16};
+  unsigned workers{4};
+  unsigned period_us{1000};
+  unsigned duration{5};
+  bool fast_fwd{false};
+
+  unsigned work_us{static_cast<unsigned>(work.count() / 1000)};
+  bool valid{true};
+  int opt;
+  while (valid && (opt = getopt(argc, argv, "n:w:p:d:t:f")) != -1) {
+    switch (opt) {
+      case 'n':
+        valid = parse_number(optarg, instances) && instances > 0;
+        break;
+      case 'w':
+        valid = parse_number(optarg, work_us);
+        break;
+      case 'p':
+        valid = parse_number(optarg, period_us) && period_us > 0;
+        break;
+      case 'd':
+        valid = parse_number(optarg, duration);
+        break;
+      case 't':
+        valid = parse_number(optarg, workers) && workers > 0;
+        break;
+      case 'f':
+        fast_fwd = true;
+        break;
+      default:
+        valid = false;
+    }
+  }
+  if (!valid || optind < argc) {
+    std::cerr << "usage: " << argv[0]
+              << " [-n instances] [-w work_us] [-p period_us] "
+                 "[-d duration_s] [-t workers] [-f]"
+              << std::endl;
+    std::cerr << "instances, period and workers need to be positive"
+              << std::endl;
+    return 1;
+  }
+  work = std::chrono::microseconds(work_us);
+
+  Environment e{workers, false, fast_fwd};
+
+  std::vector<std::unique_ptr<Ports>> ports;
+  for (unsigned i = 0; i < instances; i++) {
+    ports.emplace_back(std::make_unique<Ports>(
+        i, &e, std::chrono::microseconds(period_us)));
+  }
+  Timeout timeout{&e, std::chrono::seconds(duration)};
+
+  e.assemble();
+
+  auto start = std::chrono::steady_clock::now();
+  auto t = e.startup();
+  t.join();
+  auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - start);
+
+  long checksum{0};
+  for (auto& p : ports) {
+    checksum += p->s_add.checksum;
+  }
+
+  auto reactions = executed_reactions.load();
+  std::cout << "instances: " << instances << ", workers: " << workers
+            << ", work: " << work.count() / 1000 << "us, period: " << period_us
+            << "us, mode: " << (fast_fwd ? "fast-fwd" : "real-time")
+            << std::endl;
+  std::cout << "executed " << reactions << " reactions in " << elapsed.count()
+            << "s (" << reactions / elapsed.count()
+            << " reactions/s), checksum: " << checksum << std::endl;
+
+  return 0;
+}
@@ -37,7 +37,7 @@ class RightPedal : public Reactor {
 
  private:
   // actions
-  PhysicalAction<void> pol{"pol", this};
+  LogicalAction<void> pol{"pol", this};
 
   // reactionns
   Reaction r1{"1", 1, this, [this]() { reaction_1(); }};
@@ -158,7 +158,6 @@ int main() {
   Brake brakes{&e};
   Engine engine{&e};
 
-  e.assemble();
   left_pedal.angle.bind_to(&brake_control.angle);
   left_pedal.on_off.bind_to(&engine_control.on_off);
   brake_control.force.bind_to(&brakes.force);
@@ -166,6 +165,8 @@ int main() {
   engine_control.check.bind_to(&right_pedal.check);
   engine_control.torque.bind_to(&engine.torque);
 
+  e.assemble();
+
   e.export_dependency_graph("graph.dot");
 
   auto t = e.startup();
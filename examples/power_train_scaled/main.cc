@@ -0,0 +1,332 @@
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include <unistd.h>
+
+#include "reactor-cpp/reactor-cpp.hh"
+
+using namespace reactor;
+using namespace std::chrono_literals;
+
+// A scaled up version of the power_train example. The topology is replicated
+// a given number of times, all reactions perform a configurable amount of
+// synthetic work, and the physical actions are triggered at a configurable
+// rate by an external thread.
+
+namespace {
+
+Duration work{10us};
+std::atomic<unsigned long> executed_reactions{0};
+
+void synthetic_work() {
+  executed_reactions.fetch_add(1, std::memory_order_relaxed);
+  auto end = std::chrono::steady_clock::now() + work;
+  while (std::chrono::steady_clock::now() < end) {
+  }
+}
+
+}  // namespace
+
+class LeftPedal : public Reactor {
+ public:
+  // ports
+  Output<void> angle{"angle", this};
+  Output<void> on_off{"on_off", this};
+
+  // actions
+  PhysicalAction<void> req{"req", this};
+
+ private:
+  // reactions
+  Reaction r1{"1", 1, this, [this]() { reaction_1(); }};
+
+  void reaction_1() {
+    synthetic_work();
+    angle.set();
+    on_off.set();
+  }
+
+ public:
+  LeftPedal(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  void assemble() override {
+    r1.declare_trigger(&req);
+    r1.declare_antidependency(&angle);
+    r1.declare_antidependency(&on_off);
+  }
+};
+
+class RightPedal : public Reactor {
+ public:
+  // ports
+  Output<void> angle{"angle", this};
+  Input<void> check{"check", this};
+
+  // actions
+  PhysicalAction<void> pol{"pol", this};
+
+ private:
+  // reactions
+  Reaction r1{"1", 1, this, [this]() { reaction_1(); }};
+  Reaction r2{"2", 2, this, [this]() { reaction_2(); }};
+
+  void reaction_1() {
+    synthetic_work();
+    angle.set();
+  }
+  void reaction_2() { synthetic_work(); }
+
+ public:
+  RightPedal(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  void assemble() override {
+    r1.declare_trigger(&pol);
+    r1.declare_antidependency(&angle);
+
+    r2.declare_trigger(&check);
+  }
+};
+
+class BrakeControl : public Reactor {
+ public:
+  // ports
+  Input<void> angle{"angle", this};
+  Output<void> force{"force", this};
+
+ private:
+  Reaction r1{"1", 1, this, [this]() { reaction_1(); }};
+
+  void reaction_1() {
+    synthetic_work();
+    force.set();
+  }
+
+ public:
+  BrakeControl(const std::string& name, Environment* env)
+      : Reactor(name, env) {}
+
+  void assemble() override {
+    r1.declare_trigger(&angle);
+    r1.declare_antidependency(&force);
+  }
+};
+
+class EngineControl : public Reactor {
+ public:
+  // ports
+  Input<void> angle{"angle", this};
+  Input<void> on_off{"on_off", this};
+  Output<void> check{"check", this};
+  Output<void> torque{"torque", this};
+
+  // actions
+  PhysicalAction<void> rev{"rev", this};
+
+ private:
+  // reactions
+  Reaction r1{"1", 1, this, [this]() { reaction_1(); }};
+  Reaction r2{"2", 2, this, [this]() { reaction_2(); }};
+  Reaction r3{"3", 3, this, [this]() { reaction_3(); }};
+
+  void reaction_1() {
+    synthetic_work();
+    torque.set();
+  }
+  void reaction_2() {
+    synthetic_work();
+    torque.set();
+  }
+  void reaction_3() {
+    synthetic_work();
+    check.set();
+  }
+
+ public:
+  EngineControl(const std::string& name, Environment* env)
+      : Reactor(name, env) {}
+
+  void assemble() override {
+    r1.declare_trigger(&on_off);
+    r1.declare_antidependency(&torque);
+
+    r2.declare_trigger(&angle);
+    r2.declare_antidependency(&torque);
+
+    r3.declare_trigger(&rev);
+    r3.declare_antidependency(&check);
+  }
+};
+
+class Brake : public Reactor {
+ public:
+  // ports
+  Input<void> force{"force", this};
+
+ private:
+  // reactions
+  Reaction r1{"1", 1, this, [this]() { synthetic_work(); }};
+
+ public:
+  Brake(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  void assemble() override { r1.declare_trigger(&force); }
+};
+
+class Engine : public Reactor {
+ public:
+  // ports
+  Input<void> torque{"torque", this};
+
+ private:
+  // reactions
+  Reaction r1{"1", 1, this, [this]() { synthetic_work(); }};
+
+ public:
+  Engine(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  void assemble() override { r1.declare_trigger(&torque); }
+};
+
+struct PowerTrain {
+  LeftPedal left_pedal;
+  RightPedal right_pedal;
+  BrakeControl brake_control;
+  EngineControl engine_control;
+  Brake brakes;
+  Engine engine;
+
+  PowerTrain(unsigned i, Environment* env)
+      : left_pedal{"LP" + std::to_string(i), env}
+      , right_pedal{"RP" + std::to_string(i), env}
+      , brake_control{"BC" + std::to_string(i), env}
+      , engine_control{"EC" + std::to_string(i), env}
+      , brakes{"B" + std::to_string(i), env}
+      , engine{"E" + std::to_string(i), env} {
+    left_pedal.angle.bind_to(&brake_control.angle);
+    left_pedal.on_off.bind_to(&engine_control.on_off);
+    brake_control.force.bind_to(&brakes.force);
+    right_pedal.angle.bind_to(&engine_control.angle);
+    engine_control.check.bind_to(&right_pedal.check);
+    engine_control.torque.bind_to(&engine.torque);
+  }
+};
+
+// Parses a non-negative decimal number that fits into an unsigned int.
+bool parse_number(const char* arg, unsigned& value) {
+  char* end{nullptr};
+  errno = 0;
+  auto result = std::strtoul(arg, &end, 10);
+  if (arg[0] == '-' || end == arg || *end != '\0' || errno == ERANGE ||
+      result > std::numeric_limits<unsigned>::max()) {
+    return false;
+  }
+  value = static_cast<unsigned>(result);
+  return true;
+}
+
+int main(int argc, char** argv) {
+  unsigned instances{16};
+  unsigned workers{4};
+  unsigned rate{100};
+  unsigned duration{5};
+  bool fast_fwd{false};
+
+  unsigned work_us{static_cast<unsigned>(work.count() / 1000)};
+  bool valid{true};
+  int opt;
+  while (valid && (opt = getopt(argc, argv, "n:w:r:d:t:f")) != -1) {
+    switch (opt) {
+      case 'n':
+        valid = parse_number(optarg, instances) && instances > 0;
+        break;
+      case 'w':
+        valid = parse_number(optarg, work_us);
+        break;
+      case 'r':
+        valid = parse_number(optarg, rate) && rate > 0;
+        break;
+      case 'd':
+        valid = parse_number(optarg, duration);
+        break;
+      case 't':
+        valid = parse_number(optarg, workers) && workers > 0;
+        break;
+      case 'f':
+        fast_fwd = true;
+        break;
+      default:
+        valid = false;
+    }
+  }
+  if (!valid || optind < argc) {
+    std::cerr << "usage: " << argv[0]
+              << " [-n instances] [-w work_us] [-r rate_hz] "
+                 "[-d duration_s] [-t workers] [-f]"
+              << std::endl;
+    std::cerr << "instances, rate and workers need to be positive"
+              << std::endl;
+    return 1;
+  }
+  work = std::chrono::microseconds(work_us);
+
+  Environment e{workers, true, fast_fwd};
+
+  std::vector<std::unique_ptr<PowerTrain>> power_trains;
+  for (unsigned i = 0; i < instances; i++) {
+    power_trains.emplace_back(std::make_unique<PowerTrain>(i, &e));
+  }
+
+  e.assemble();
+
+  auto start = std::chrono::steady_clock::now();
+  auto t = e.startup();
+
+  // Trigger all physical actions at the given rate, and shut down after the
+  // given duration.
+  std::thread sensors([&]() {
+    auto period = std::chrono::nanoseconds(1s) / rate;
+    auto next = std::chrono::steady_clock::now();
+    auto end = next + std::chrono::seconds(duration);
+    unsigned long count{0};
+    while (next < end) {
+      for (auto& p : power_trains) {
+        switch (count % 3) {
+          case 0:
+            p->left_pedal.req.schedule();
+            break;
+          case 1:
+            p->right_pedal.pol.schedule();
+            break;
+          default:
+            p->engine_control.rev.schedule();
+        }
+      }
+      count++;
+      next += period;
+      std::this_thread::sleep_until(next);
+    }
+    e.async_shutdown();
+  });
+
+  sensors.join();
+  t.join();
+  auto elapsed = std::chrono::duration_cast<std::chrono::duration<double>>(
+      std::chrono::steady_clock::now() - start);
+
+  auto reactions = executed_reactions.load();
+  std::cout << "instances: " << instances << ", workers: " << workers
+            << ", work: " << work.count() / 1000 << "us, rate: " << rate
+            << "Hz, mode: " << (fast_fwd ? "fast-fwd" : "real-time")
+            << std::endl;
+  std::cout << "executed " << reactions << " reactions in " << elapsed.count()
+            << "s (" << reactions / elapsed.count() << " reactions/s)"
+            << std::endl;
+
+  return 0;
+}
@@ -8,6 +8,10 @@
 
 #pragma once
 
+#include <iterator>
+#include <type_traits>
+#include <vector>
+
 #include "logical_time.hh"
 #include "reactor.hh"
 #include "value_ptr.hh"
@@ -18,6 +22,7 @@ class BaseAction : public ReactorElement {
  private:
   std::set<Reaction*> _triggers;
   std::set<Reaction*> _schedulers;
+  std::vector<Reaction*> _active_triggers;
 
   const bool _logical;
 
@@ -41,6 +46,9 @@ class BaseAction : public ReactorElement {
  public:
   const auto& triggers() const { return _triggers; }
   const auto& schedulers() const { return _schedulers; }
+  const auto& active_triggers() const { return _active_triggers; }
+
+  void update_active_triggers();
 
   bool is_logical() const { return _logical; }
   bool is_physical() const { return !_logical; }
@@ -63,6 +71,12 @@ class Action : public BaseAction {
          Duration min_delay)
       : BaseAction(name, container, logical, min_delay) {}
 
+  void schedule_at(const ImmutableValuePtr<T>& value_ptr, const Tag& tag);
+
+  // only available for logical actions (see LogicalAction::schedule_many())
+  template <class InputIt>
+  void schedule_many(InputIt first, InputIt last);
+
  public:
   void startup() override final {}
   void shutdown() override final {}
@@ -104,6 +118,10 @@ class Action<void> : public BaseAction {
          Duration min_delay)
       : BaseAction(name, container, logical, min_delay) {}
 
+  // only available for logical actions (see LogicalAction::schedule_many())
+  template <class InputIt>
+  void schedule_many(InputIt first, InputIt last);
+
  public:
   void startup() override final {}
   void shutdown() override final {}
@@ -127,14 +145,31 @@ class LogicalAction : public Action<T> {
                 Reactor* container,
                 Duration min_delay = Duration::zero())
       : Action<T>(name, container, true, min_delay) {}
+
+  /**
+   * Schedule the action multiple times in one operation.
+   *
+   * The range contains pairs of a delay and a value, which may be given
+   * either as an `ImmutableValuePtr<T>` or as a `T`. For actions of type
+   * void, the range only contains delays. This is equivalent to calling
+   * `schedule()` for each element in order, but the events are inserted in
+   * bulk.
+   */
+  using Action<T>::schedule_many;
+  template <class Container>
+  void schedule_many(const Container& events) {
+    schedule_many(std::begin(events), std::end(events));
+  }
 };
 
 class Timer : public BaseAction {
  private:
   const Duration _offset;
   const Duration _period;
+  Mode* _mode{nullptr};
 
   void reschedule();
+  void schedule_first(const Tag& t0);
 
   void cleanup() override final;
 
@@ -150,8 +185,14 @@ class Timer : public BaseAction {
   void startup() override final;
   void shutdown() override final {}
 
+  void restart();
+
   const Duration& offset() const { return _offset; }
   const Duration& period() const { return _period; }
+  Mode* mode() const { return _mode; }
+  bool is_active() const;
+
+  friend Mode;
 };
 
 class StartupAction : public Timer {
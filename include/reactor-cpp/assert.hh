@@ -8,6 +8,8 @@
 
 #pragma once
 
+#include "config.hh"
+
 #ifdef REACTOR_CPP_VALIDATE
 #define RUNTIME_VALIDATE true
 #else
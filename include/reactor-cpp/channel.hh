@@ -0,0 +1,160 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <atomic>
+#include <vector>
+
+#include "action.hh"
+#include "logical_time.hh"
+#include "scheduler.hh"
+#include "value_ptr.hh"
+
+namespace reactor {
+
+template <class T>
+class ChannelAction;
+
+/**
+ * A bounded single-producer single-consumer channel for passing values from
+ * one environment to another environment within the same process.
+ *
+ * Values are handed over as immutable value pointers and are never copied.
+ * The producer side never blocks and never acquires a lock. Values are
+ * received by a `ChannelAction` in the receiving environment, whose scheduler
+ * drains the channel in bulk in between two tags.
+ *
+ * Only a single thread may send on a channel at a time. When sending from
+ * reactions, this is guaranteed if there is only one sending reaction, or if
+ * all sending reactions belong to the same reactor and either none of them
+ * declares a state partition or all of them declare the same partition.
+ * Reactions of different partitions may execute concurrently.
+ */
+template <class T>
+class Channel {
+ private:
+  struct Entry {
+    ImmutableValuePtr<T> value{nullptr};
+    TimePoint time_point{};
+  };
+
+  std::vector<Entry> ring;
+  const std::size_t mask;
+
+  // Keep the producer and consumer positions on separate cache lines
+  alignas(64) std::atomic<std::size_t> head{0};
+  alignas(64) std::atomic<std::size_t> tail{0};
+
+  Scheduler* receiver{nullptr};
+
+  static std::size_t round_up(std::size_t capacity) {
+    std::size_t size = 1;
+    while (size < capacity) {
+      size <<= 1;
+    }
+    return size;
+  }
+
+ public:
+  explicit Channel(std::size_t capacity)
+      : ring(round_up(capacity)), mask(round_up(capacity) - 1) {}
+
+  Channel(const Channel&) = delete;
+
+  /**
+   * Send a value that should be received at the given time point.
+   *
+   * The receiving environment translates the time point to a tag on its own
+   * timeline. If the time point lies in the logical past of the receiver, the
+   * value is received in the next possible microstep. Returns false if the
+   * channel is full.
+   */
+  bool send(const ImmutableValuePtr<T>& value, TimePoint time_point) {
+    reactor::validate(value != nullptr, "Channels may not carry nullptr!");
+    auto t = tail.load(std::memory_order_relaxed);
+    if (t - head.load(std::memory_order_acquire) == ring.size()) {
+      return false;
+    }
+    auto& entry = ring[t & mask];
+    entry.value = value;
+    entry.time_point = time_point;
+    tail.store(t + 1);
+    if (receiver != nullptr) {
+      receiver->notify_ingress();
+    }
+    return true;
+  }
+  bool send(MutableValuePtr<T>&& value, TimePoint time_point) {
+    return send(ImmutableValuePtr<T>(std::forward<MutableValuePtr<T>>(value)),
+                time_point);
+  }
+
+  bool empty() const { return tail.load() == head.load(); }
+  std::size_t capacity() const { return ring.size(); }
+
+  friend ChannelAction<T>;
+};
+
+/**
+ * The receiving end of a channel.
+ *
+ * Behaves like a physical action of the receiving reactor that is scheduled
+ * for each value sent on the channel.
+ */
+template <class T>
+class ChannelAction : public Action<T>, public Ingress {
+ private:
+  Channel<T>* const channel;
+  // the last tag assigned to a received value
+  LogicalTime last_tag{};
+
+ public:
+  ChannelAction(const std::string& name,
+                Reactor* container,
+                Channel<T>* channel)
+      : Action<T>(name, container, false, Duration::zero())
+      , channel(channel) {
+    reactor::validate(channel->receiver == nullptr,
+             "A channel may only have a single receiver!");
+    channel->receiver = this->environment()->scheduler();
+    channel->receiver->register_ingress(this);
+  }
+
+  ~ChannelAction() {
+    channel->receiver->unregister_ingress(this);
+    channel->receiver = nullptr;
+  }
+
+  bool pending() const override { return !channel->empty(); }
+
+  void drain() override {
+    auto scheduler = this->environment()->scheduler();
+    auto h = channel->head.load(std::memory_order_relaxed);
+    auto t = channel->tail.load(std::memory_order_acquire);
+    for (; h != t; h++) {
+      auto& entry = channel->ring[h & channel->mask];
+
+      // Each value needs its own tag as an action can only hold one value per
+      // tag. Thus, values are placed at the next free tag if their time point
+      // lies in the past of the receiver.
+      auto now = Tag::from_logical_time(scheduler->logical_time());
+      auto last = Tag::from_logical_time(last_tag);
+      auto bound = last < now ? now : last;
+      auto time_point_tag = Tag::from_physical_time(entry.time_point);
+      auto tag = time_point_tag <= bound ? bound.delay() : time_point_tag;
+      last_tag.advance_to(tag);
+
+      this->schedule_at(std::move(entry.value), tag);
+      entry.value = nullptr;
+    }
+    channel->head.store(h, std::memory_order_release);
+  }
+};
+
+}  // namespace reactor
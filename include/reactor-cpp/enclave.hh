@@ -0,0 +1,117 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "channel.hh"
+#include "environment.hh"
+#include "logging.hh"
+#include "port.hh"
+#include "reaction.hh"
+#include "reactor.hh"
+
+namespace reactor {
+
+/**
+ * A connection between two environments, typically an enclave and its
+ * parent.
+ *
+ * The connection consists of an input port in the sending environment and an
+ * output port in the receiving environment, which are bound to ports of
+ * reactors in either environment. Each value set on the input is passed on
+ * via a channel, tagged with the logical time at which it was set, and the
+ * output is set at the corresponding tag on the timeline of the receiving
+ * environment. If that tag already lies in the past of the receiver, the
+ * value is delivered at the next possible microstep (see `ChannelAction`).
+ *
+ * The sending environment never blocks. If the receiver falls behind by more
+ * than the capacity of the connection, further values are dropped.
+ */
+template <class T>
+class EnclaveConnection {
+ private:
+  Channel<T> channel;
+  std::atomic<std::uint64_t> _dropped{0};
+
+  class Sender : public Reactor {
+   private:
+    EnclaveConnection<T>& connection;
+
+    Reaction send{"send", 1, this, [this]() {
+                    if (!connection.channel.send(in.get(),
+                                                 get_logical_time())) {
+                      connection._dropped.fetch_add(
+                          1, std::memory_order_relaxed);
+                      log::Warn() << "Connection " << fqn()
+                                  << " is full; dropping a value";
+                    }
+                  }};
+
+   public:
+    Input<T> in{"in", this};
+
+    Sender(const std::string& name,
+           Environment* environment,
+           EnclaveConnection<T>& connection)
+        : Reactor(name, environment), connection(connection) {}
+
+    void assemble() override { send.declare_trigger(&in); }
+  };
+
+  class Receiver : public Reactor {
+   private:
+    ChannelAction<T> received;
+
+    Reaction forward{"forward", 1, this,
+                     [this]() { out.set(received.get()); }};
+
+   public:
+    Output<T> out{"out", this};
+
+    Receiver(const std::string& name,
+             Environment* environment,
+             Channel<T>* channel)
+        : Reactor(name, environment), received{"received", this, channel} {}
+
+    void assemble() override {
+      forward.declare_trigger(&received);
+      forward.declare_antidependency(&out);
+    }
+  };
+
+  Sender sender;
+  Receiver receiver;
+
+ public:
+  EnclaveConnection(const std::string& name,
+                    Environment* from,
+                    Environment* to,
+                    std::size_t capacity = 64)
+      : channel(capacity)
+      , sender(name, from, *this)
+      , receiver(name, to, &channel) {
+    reactor::validate(from != to,
+             "Enclave connections require two distinct environments!");
+  }
+
+  /// The port that receives values in the sending environment.
+  Input<T>& input() { return sender.in; }
+  /// The port that provides values in the receiving environment.
+  Output<T>& output() { return receiver.out; }
+
+  /// The number of values that were dropped because the channel was full.
+  std::uint64_t dropped() const {
+    return _dropped.load(std::memory_order_relaxed);
+  }
+};
+
+}  // namespace reactor
@@ -8,6 +8,11 @@
 
 #pragma once
 
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
 #include <set>
 #include <string>
 #include <vector>
@@ -24,6 +29,7 @@ class Environment {
     Assembly,
     Startup,
     Execution,
+    Mutation,
     Shutdown,
     Deconstruction
   };
@@ -35,18 +41,54 @@ class Environment {
   const bool _fast_fwd_execution;
   std::set<Reactor*> _top_level_reactors;
 
+  // enclaves are nested environments that are started and shut down along
+  // with this environment
+  std::vector<Environment*> _enclaves;
+  std::vector<std::thread> _enclave_threads;
+
   std::set<Reaction*> reactions;
-  using Dependency = std::pair<Reaction*, Reaction*>;
-  std::vector<Dependency> dependencies;
+  // pure reactions without observable effects, which are not part of the
+  // dependency graph
+  std::set<Reaction*> pruned_reactions;
+  // maps each reaction to the reactions it depends on and vice versa
+  std::map<Reaction*, std::set<Reaction*>> dependencies;
+  std::map<Reaction*, std::set<Reaction*>> dependents;
   Phase _phase{Phase::Construction};
 
+  void add_dependency(Reaction* reaction, Reaction* dependency);
+  void remove_dependencies(Reaction* reaction);
+  void add_port_dependencies(Reaction* reaction);
+  void add_priority_dependencies(Reaction* reaction);
   void build_dependency_graph(Reactor* reactor);
   void calculate_indexes();
+  std::set<Reaction*> find_observable_reactions() const;
+  void prune_reactions();
+  std::set<Reaction*> revive_reactions();
+
+  // state for runtime mutations of the topology
+  std::mutex m_mutations;
+  std::vector<std::function<void(void)>> mutations;
+  std::atomic<bool> _mutations_pending{false};
+  std::set<Reactor*> added_reactors;
+  std::set<BasePort*> changed_ports;
+  // a shutdown that was requested while a mutation was applied
+  bool _shutdown_pending{false};
+
+  bool apply_mutations(std::unique_lock<std::mutex>& lock);
+  bool update_indexes(const std::set<Reaction*>& affected);
+  void mark_port_changed(BasePort* port);
 
   TimePoint _start_time;
 
   unsigned _max_reaction_index;
 
+  std::atomic<bool> _profiling{false};
+  TimePoint _profiling_start{};
+  std::uint64_t _profiled_tags{0};
+
+  void profile_execution(Reaction* reaction, TimePoint start, TimePoint finish);
+  void profile_critical_path(Reaction* last);
+
  public:
   Environment(unsigned num_workers,
               bool run_forever = false,
@@ -56,18 +98,102 @@ class Environment {
       , _run_forever(run_forever)
       , _fast_fwd_execution(fast_fwd_execution) {}
 
+  /**
+   * Create an enclave within the given environment.
+   *
+   * An enclave is an environment with its own scheduler, event queue, workers
+   * and logical timeline. It is assembled, started and shut down along with
+   * its parent, and it keeps running until its parent shuts down, even if
+   * its event queue runs empty. Reactors in an enclave may only communicate
+   * with reactors in other environments via `EnclaveConnection`s.
+   */
+  Environment(Environment* parent,
+              unsigned num_workers,
+              bool fast_fwd_execution = false);
+
   void register_reactor(Reactor* reactor);
 
+  /**
+   * Request a mutation of the program topology.
+   *
+   * The given function is executed by the scheduler at the next safe point
+   * between two tags, i.e., when no reactions are executing. Within the
+   * function, new top level reactors may be created, ports may be bound or
+   * unbound and top level reactors may be removed using `remove_reactor()`.
+   * Elements may not be added to reactors that existed before the mutation.
+   * If the mutation introduces a loop in the dependency graph, the error is
+   * logged and the execution stops without processing any further tags.
+   * This method is thread-safe and may be called from reactions as well as
+   * from external threads.
+   */
+  void request_mutation(std::function<void(void)> mutation);
+
+  /**
+   * Remove a top level reactor and all its contained elements from the
+   * program. Pending events of its actions are discarded and its shutdown
+   * reactions are not executed, as the removed reactions are no longer part
+   * of the dependency graph. Thus, the reactor needs to release any
+   * resources in its destructor. May only be called within a mutation.
+   */
+  void remove_reactor(Reactor* reactor);
+  /// Check whether the given reactor is contained in a top level reactor
+  /// that was created by the mutation that is currently applied.
+  bool is_added_by_mutation(Reactor* reactor) const;
+  bool mutations_pending() const {
+    return _mutations_pending.load(std::memory_order_acquire);
+  }
+
   const auto& top_level_reactors() const { return _top_level_reactors; }
+  const auto& enclaves() const { return _enclaves; }
+  /// Maps each reaction to the reactions it directly depends on.
+  const auto& reaction_dependencies() const { return dependencies; }
+
+  /**
+   * Execute reactions in tasks submitted to the given executor instead of on
+   * threads owned by the environment. The executor needs to outlive the
+   * execution. Note that in real-time mode, a task may block while waiting
+   * for physical time to reach the next tag.
+   */
+  void set_executor(Executor* executor);
+
+  /**
+   * Replace the policy that decides which of the triggered reactions are
+   * executed next (see `SchedulingPolicy`). By default, reactions are
+   * executed level by level (see `LevelPolicy`).
+   */
+  void set_scheduling_policy(std::unique_ptr<SchedulingPolicy> policy);
 
   void assemble();
   std::thread startup();
   void sync_shutdown();
   void async_shutdown();
 
-  void export_dependency_graph(const std::string& path);
+  /**
+   * Write the reaction graph in the dot format. If `with_profile` is set,
+   * each reaction is annotated with its execution time and frequency, and
+   * each dependency with how often it was on the critical path of a tag. The
+   * colors highlight the reactions that take up most of the execution time
+   * and the dependencies that are most often critical.
+   */
+  void export_dependency_graph(const std::string& path,
+                               bool with_profile = false);
+
+  /**
+   * Collect execution statistics of all reactions (see `Reaction::profile()`).
+   * The statistics may only be read when no reactions are executing, i.e.,
+   * after the execution finished or during a mutation.
+   */
+  void enable_profiling();
+  bool profiling() const { return _profiling.load(std::memory_order_relaxed); }
+  std::uint64_t profiled_tags() const { return _profiled_tags; }
 
   Phase phase() const { return _phase; }
+  bool allows_construction() const {
+    return _phase == Phase::Construction || _phase == Phase::Mutation;
+  }
+  bool allows_assembly() const {
+    return _phase == Phase::Assembly || _phase == Phase::Mutation;
+  }
   const Scheduler* scheduler() const { return &_scheduler; }
   Scheduler* scheduler() { return &_scheduler; }
 
@@ -80,6 +206,10 @@ class Environment {
   bool run_forever() const { return _run_forever; }
 
   unsigned max_reaction_index() const { return _max_reaction_index; }
+
+  friend BasePort;
+  friend Scheduler;
+  friend Worker;
 };
 
 }  // namespace reactor
@@ -0,0 +1,162 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "config.hh"
+#include "fwd.hh"
+#include "logical_time.hh"
+#include "time.hh"
+
+namespace reactor {
+
+#ifdef REACTOR_CPP_FLIGHT_RECORDER
+constexpr bool flight_recorder_enabled = true;
+#else
+constexpr bool flight_recorder_enabled = false;
+#endif
+
+class ReactorElement;
+
+enum class FlightEvent : std::uint32_t {
+  ReactionExecutionStarts,
+  ReactionExecutionFinishes,
+  ScheduleAction,
+  TriggerReaction,
+  DeadlineMiss,
+  LagSpike,
+  TagAdvance,
+  LevelStarts,
+  LevelFinishes,
+  PhysicalTimeSleepStarts,
+  PhysicalTimeSleepFinishes,
+  WorkerParks,
+  WorkerUnparks,
+  IngressDrain
+};
+
+/**
+ * Continuously records the most recent scheduling events into a fixed-size
+ * in-memory ring.
+ *
+ * Recording an event only claims a slot with a single atomic increment and
+ * fills in a few words. Names are resolved only when the ring is dumped.
+ * The ring is dumped to a trace file in the Chrome trace format (the same
+ * format produced by `tracing/ctf_to_json.py`) on request, when a deadline
+ * handler is invoked, or when the lag of physical time behind logical time
+ * exceeds a threshold at the beginning of a tag. Only events within the
+ * configured window before the trigger are written.
+ *
+ * Dumps caused by the automatic triggers are rate limited to at most one per
+ * window. They are handed off to a background thread that copies the events
+ * from the ring and writes the file, so that a trigger does not stall the
+ * worker that caused it. Events that are overwritten before the background
+ * thread copies them are missing from the dump.
+ *
+ * The recorder is only fed if the library is built with
+ * REACTOR_CPP_FLIGHT_RECORDER. All reactor elements that appear in the
+ * ring need to be alive when a dump is triggered.
+ */
+class FlightRecorder {
+ private:
+  // Records are written and read following the seqlock pattern. All fields
+  // are atomic to avoid data races with concurrent dumps.
+  struct Record {
+    // index + 1 of the record that was last completely written to the slot
+    std::atomic<std::uint64_t> sequence{0};
+    std::atomic<const ReactorElement*> element{nullptr};
+    std::atomic<std::int64_t> time{0};
+    std::atomic<std::int64_t> tag_time{0};
+    // the micro step of the tag, the lag for deadline misses and spikes,
+    // level << 32 | width for levels, or the number of drained ingresses
+    std::atomic<std::uint64_t> argument{0};
+    std::atomic<FlightEvent> type{FlightEvent::ReactionExecutionStarts};
+    std::atomic<std::int32_t> worker{-1};
+  };
+
+  struct Snapshot {
+    const ReactorElement* element;
+    std::int64_t time;
+    std::int64_t tag_time;
+    std::uint64_t argument;
+    FlightEvent type;
+    std::int32_t worker;
+  };
+
+  std::unique_ptr<Record[]> ring{};
+  std::size_t mask{0};
+  std::atomic<std::uint64_t> position{0};
+
+  std::atomic<Duration::rep> window{Duration::zero().count()};
+  std::atomic<Duration::rep> lag_threshold{Duration::zero().count()};
+  std::atomic<bool> dump_on_deadline_miss{true};
+  std::atomic<std::int64_t> last_automatic_dump{0};
+
+  // the fields below are protected by m_dump
+  std::mutex m_dump;
+  std::condition_variable cv_dump;
+  std::string file_prefix{"flight_recorder"};
+  unsigned dump_counter{0};
+  bool dump_pending{false};
+  TimePoint dump_time{};
+  bool terminate_writer{false};
+  std::thread writer{};
+
+  std::vector<Snapshot> snapshot(TimePoint until);
+  static void write(const std::string& path, std::vector<Snapshot> records);
+  void trigger(TimePoint time);
+  void run_writer();
+
+ public:
+  FlightRecorder();
+  ~FlightRecorder();
+
+  /**
+   * Set the capacity of the ring (rounded up to a power of two) and the span
+   * of time before a trigger that is written to a dump. This discards all
+   * recorded events and must not be called while events are recorded.
+   */
+  void configure(std::size_t capacity, Duration window);
+  /// Dump when the lag exceeds the threshold. Zero disables this trigger.
+  void set_lag_threshold(Duration threshold) {
+    lag_threshold.store(threshold.count(), std::memory_order_relaxed);
+  }
+  void set_dump_on_deadline_miss(bool enable) {
+    dump_on_deadline_miss.store(enable, std::memory_order_relaxed);
+  }
+  /// Dumps are written to `<prefix>-<n>.json`
+  void set_file_prefix(const std::string& prefix);
+
+  void record(FlightEvent type,
+              const ReactorElement* element,
+              TimePoint tag_time = TimePoint{},
+              std::uint64_t argument = 0);
+
+  /// Record a deadline miss and dump the ring if configured to do so
+  void deadline_missed(const Reaction* reaction, Duration lag);
+  /// Check the lag at the beginning of a tag and dump the ring if necessary
+  void check_lag(const LogicalTime& logical_time);
+
+  /// Synchronously write all events within the window to the given file
+  void dump(const std::string& path);
+
+  static FlightRecorder& instance();
+};
+
+inline FlightRecorder& flight_recorder() { return FlightRecorder::instance(); }
+
+}  // namespace reactor
@@ -13,10 +13,12 @@ namespace reactor {
 class BaseAction;
 class BasePort;
 class Environment;
+class Mode;
 class Reaction;
 class Reactor;
 class Scheduler;
 class Tag;
+class Timer;
 
 template <class T>
 class Action;
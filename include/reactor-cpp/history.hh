@@ -0,0 +1,150 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <vector>
+
+#include "assert.hh"
+#include "environment.hh"
+#include "port.hh"
+
+namespace reactor {
+
+/**
+ * A read-only view of contiguous elements, ordered from the oldest to the
+ * most recent one.
+ */
+template <class T>
+class HistoryView {
+ private:
+  const T* _data;
+  std::size_t _size;
+
+ public:
+  HistoryView(const T* data, std::size_t size) : _data(data), _size(size) {}
+
+  const T* data() const { return _data; }
+  std::size_t size() const { return _size; }
+  bool empty() const { return _size == 0; }
+
+  const T& operator[](std::size_t i) const { return _data[i]; }
+  const T& front() const { return _data[0]; }
+  const T& back() const { return _data[_size - 1]; }
+
+  const T* begin() const { return _data; }
+  const T* end() const { return _data + _size; }
+};
+
+/**
+ * An input port that keeps the last values it received.
+ *
+ * Whenever the port becomes present, a pointer to its value is stored in a
+ * ring of the given depth along with the current tag. Values are shared
+ * with the port and not copied. If the port is set multiple times within
+ * the same tag, only the last value is kept. The ring is stored twice, so
+ * that the window of recorded values is always contiguous and can be
+ * accessed without copying. The storage is allocated once on construction;
+ * recording a value does not allocate.
+ *
+ * Lazy values (see Port::set_lazy()) are not computed when they are
+ * recorded, but only when the history is read for the first time.
+ *
+ * The values recorded up to and including the current tag can be accessed
+ * by all reactions that depend on the port.
+ */
+template <class T>
+class HistoryInput : public Input<T> {
+  static_assert(!std::is_void<T>::value,
+                "History ports require a value type");
+
+ private:
+  using LazyValue = typename Port<T>::LazyValue;
+
+  const std::size_t depth;
+  mutable std::vector<ImmutableValuePtr<T>> _values;
+  std::vector<LogicalTime> _tags;
+  // lazy values in the first copy of the ring that were not yet computed
+  mutable std::vector<std::shared_ptr<LazyValue>> lazy;
+  mutable std::atomic<bool> lazy_pending{false};
+  mutable std::mutex m_lazy;
+  // position of the next value in the first copy of the ring
+  std::size_t next{0};
+  std::size_t _size{0};
+
+  void record_history() override final {
+    const auto& tag = this->environment()->logical_time();
+    auto last = (next + depth - 1) % depth;
+    if (_size == 0 || _tags[last] != Tag::from_logical_time(tag)) {
+      last = next;
+      next = (next + 1) % depth;
+      if (_size < depth) {
+        _size++;
+      }
+    }
+    lazy[last] = this->pending_lazy_value();
+    if (lazy[last] != nullptr) {
+      _values[last] = nullptr;
+      lazy_pending.store(true, std::memory_order_relaxed);
+    } else {
+      _values[last] = this->get();
+    }
+    _values[last + depth] = _values[last];
+    _tags[last] = tag;
+    _tags[last + depth] = tag;
+  }
+
+  void evaluate_lazy_values() const {
+    std::lock_guard<std::mutex> lg(m_lazy);
+    // another reader might have evaluated the values in the meantime
+    if (lazy_pending.load(std::memory_order_relaxed)) {
+      for (std::size_t i = 0; i < depth; i++) {
+        if (lazy[i] != nullptr) {
+          _values[i] = lazy[i]->get();
+          _values[i + depth] = _values[i];
+          lazy[i] = nullptr;
+        }
+      }
+      lazy_pending.store(false, std::memory_order_release);
+    }
+  }
+
+  std::size_t first() const { return next + depth - _size; }
+
+ public:
+  HistoryInput(const std::string& name, Reactor* container, std::size_t depth)
+      : Input<T>(name, container), depth(depth) {
+    reactor::validate(depth > 0, "History ports require a non-zero depth!");
+    _values.resize(2 * depth);
+    _tags.resize(2 * depth);
+    lazy.resize(depth);
+    this->records_history = true;
+  }
+
+  std::size_t capacity() const { return depth; }
+
+  /// The recorded values, ending with the most recent one.
+  HistoryView<ImmutableValuePtr<T>> values() const {
+    if (lazy_pending.load(std::memory_order_acquire)) {
+      evaluate_lazy_values();
+    }
+    return HistoryView<ImmutableValuePtr<T>>(_values.data() + first(), _size);
+  }
+
+  /// The tags of the recorded values.
+  HistoryView<LogicalTime> tags() const {
+    return HistoryView<LogicalTime>(_tags.data() + first(), _size);
+  }
+};
+
+}  // namespace reactor
@@ -31,6 +31,41 @@ void Action<T>::schedule(const ImmutableValuePtr<T>& value_ptr, Dur delay) {
   }
 }
 
+template <class T>
+void Action<T>::schedule_at(const ImmutableValuePtr<T>& value_ptr,
+                            const Tag& tag) {
+  auto setup = [value_ptr, this]() { this->value_ptr = std::move(value_ptr); };
+  environment()->scheduler()->schedule_sync(tag, this, setup);
+}
+
+template <class T>
+template <class InputIt>
+void Action<T>::schedule_many(InputIt first, InputIt last) {
+  auto scheduler = environment()->scheduler();
+  auto now = Tag::from_logical_time(scheduler->logical_time());
+  Scheduler::EventList events;
+  for (; first != last; ++first) {
+    const auto& event = *first;
+    auto d = std::chrono::duration_cast<Duration>(event.first);
+    reactor::validate(d >= Duration::zero(),
+             "Schedule cannot be called with a negative delay!");
+    ImmutableValuePtr<T> value_ptr{nullptr};
+    if constexpr (std::is_same<std::decay_t<decltype(event.second)>,
+                               ImmutableValuePtr<T>>::value) {
+      reactor::validate(event.second != nullptr,
+               "Actions may not be scheduled with a nullptr value!");
+      value_ptr = event.second;
+    } else {
+      value_ptr = make_immutable_value<T>(event.second);
+    }
+    events.emplace_back(now.delay(d + this->min_delay),
+                        [value_ptr = std::move(value_ptr), this]() {
+                          this->value_ptr = std::move(value_ptr);
+                        });
+  }
+  scheduler->schedule_sync(this, events);
+}
+
 template <class Dur>
 void Action<void>::schedule(Dur delay) {
   auto d = std::chrono::duration_cast<Duration>(delay);
@@ -49,4 +84,19 @@ void Action<void>::schedule(Dur delay) {
   }
 }
 
+template <class InputIt>
+void Action<void>::schedule_many(InputIt first, InputIt last) {
+  auto scheduler = environment()->scheduler();
+  auto now = Tag::from_logical_time(scheduler->logical_time());
+  Scheduler::EventList events;
+  for (; first != last; ++first) {
+    auto d = std::chrono::duration_cast<Duration>(*first);
+    reactor::validate(d >= Duration::zero(),
+             "Schedule cannot be called with a negative delay!");
+    events.emplace_back(now.delay(d + this->min_delay),
+                        [this]() { this->present = true; });
+  }
+  scheduler->schedule_sync(this, events);
+}
+
 }  // namespace reactor
@@ -12,11 +12,51 @@
 namespace reactor {
 
 template <class T>
-const std::set<Port<T>*>& Port<T>::typed_outward_bindings() const {
+const std::vector<Port<T>*>& Port<T>::typed_outward_bindings() const {
   // HACK this cast is ugly but should be safe as long as we only allow to
-  // bind with Port<T>*. The alternative would be to copy the entire set and
-  // cast each element individually, which is also ugly...
-  return reinterpret_cast<const std::set<Port<T>*>&>(outward_bindings());
+  // bind with Port<T>*. The alternative would be to copy the entire vector
+  // and cast each element individually, which is also ugly...
+  return reinterpret_cast<const std::vector<Port<T>*>&>(outward_bindings());
+}
+
+// The bulk binding methods rely on the same cast as typed_outward_bindings()
+// to avoid copying the port vectors.
+
+template <class T>
+void Port<T>::bind_to(const std::vector<Port<T>*>& ports) {
+  // broadcast the value of this port to all given ports
+  Port<T>* from = this;
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(&from), 1,
+                 reinterpret_cast<BasePort* const*>(ports.data()),
+                 ports.size(), 1);
+}
+
+template <class T>
+void Port<T>::bind_one_to_each(const std::vector<Port<T>*>& from,
+                               const std::vector<Port<T>*>& to) {
+  reactor::validate(from.size() == to.size(),
+           "bind_one_to_each() requires the same number of ports on both "
+           "sides!");
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(from.data()), from.size(),
+                 reinterpret_cast<BasePort* const*>(to.data()), to.size(), 1);
+}
+
+template <class T>
+void Port<T>::bind_repeated(const std::vector<Port<T>*>& from,
+                            const std::vector<Port<T>*>& to) {
+  // to is a sequence of groups, each bound to the ports in from in order
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(from.data()), from.size(),
+                 reinterpret_cast<BasePort* const*>(to.data()), to.size(), 1);
+}
+
+template <class T>
+void Port<T>::bind_interleaved(const std::vector<Port<T>*>& from,
+                               const std::vector<Port<T>*>& to) {
+  // each port in from is bound to a consecutive group of ports in to
+  auto group_size = from.empty() ? 0 : to.size() / from.size();
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(from.data()), from.size(),
+                 reinterpret_cast<BasePort* const*>(to.data()), to.size(),
+                 group_size);
 }
 
 template <class T>
@@ -26,6 +66,51 @@ Port<T>* Port<T>::typed_inward_binding() const {
   return static_cast<Port<T>*>(inward_binding());
 }
 
+template <class T>
+void Port<T>::LazyValue::reset(std::function<T(void)>&& compute) {
+  this->compute = std::move(compute);
+  value = nullptr;
+  pending.store(true, std::memory_order_relaxed);
+}
+
+template <class T>
+void Port<T>::LazyValue::clear() {
+  pending.store(false, std::memory_order_relaxed);
+  compute = nullptr;
+  value = nullptr;
+}
+
+template <class T>
+void Port<T>::LazyValue::evaluate() {
+  std::lock_guard<std::mutex> lg(mutex);
+  // another reader might have computed the value in the meantime
+  if (pending.load(std::memory_order_relaxed)) {
+    value = make_immutable_value<T>(compute());
+    compute = nullptr;
+    pending.store(false, std::memory_order_release);
+  }
+}
+
+template <class T>
+const ImmutableValuePtr<T>& Port<T>::LazyValue::get() {
+  if (pending.load(std::memory_order_acquire)) {
+    evaluate();
+  }
+  return value;
+}
+
+template <class T>
+std::shared_ptr<typename Port<T>::LazyValue> Port<T>::pending_lazy_value()
+    const {
+  if (has_inward_binding()) {
+    return typed_inward_binding()->pending_lazy_value();
+  }
+  if (is_lazy && lazy->pending.load(std::memory_order_acquire)) {
+    return lazy;
+  }
+  return nullptr;
+}
+
 template <class T>
 void Port<T>::set(const ImmutableValuePtr<T>& value_ptr) {
   reactor::validate(!has_inward_binding(),
@@ -34,6 +119,24 @@ void Port<T>::set(const ImmutableValuePtr<T>& value_ptr) {
   reactor::validate(value_ptr != nullptr, "Ports may not be set to nullptr!");
   auto scheduler = environment()->scheduler();
   this->value_ptr = std::move(value_ptr);
+  is_lazy = false;
+  scheduler->set_port(this);
+}
+
+template <class T>
+void Port<T>::set_lazy(std::function<T(void)> compute) {
+  reactor::validate(!has_inward_binding(),
+           "set_lazy() may only be called on a ports that do not have an "
+           "inward binding!");
+  reactor::validate(compute != nullptr, "Ports may not be set to nullptr!");
+  auto scheduler = environment()->scheduler();
+  // a lazy value that is still referenced by a history may not be reused
+  if (lazy == nullptr || lazy.use_count() > 1) {
+    lazy = std::make_shared<LazyValue>();
+  }
+  this->value_ptr = nullptr;
+  lazy->reset(std::move(compute));
+  is_lazy = true;
   scheduler->set_port(this);
 }
 
@@ -42,6 +145,9 @@ const ImmutableValuePtr<T>& Port<T>::get() const {
   if (has_inward_binding()) {
     return typed_inward_binding()->get();
   } else {
+    if (is_lazy) {
+      return lazy->get();
+    }
     return value_ptr;
   }
 }
@@ -51,7 +157,8 @@ bool Port<T>::is_present() const {
   if (has_inward_binding()) {
     return typed_inward_binding()->is_present();
   } else {
-    return value_ptr != nullptr;
+    // a lazy value is present even if it was not computed yet
+    return is_lazy || value_ptr != nullptr;
   }
 }
 
@@ -0,0 +1,47 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <set>
+
+#include "reactor.hh"
+
+namespace reactor {
+
+/**
+ * A mode groups reactions and timers of a reactor that are only active while
+ * the mode is the active mode of its reactor.
+ *
+ * The first mode created within a reactor is its initial mode. Reactions and
+ * timers that are not declared to belong to any mode are always active.
+ * Reactions of an inactive mode are never triggered and timers of an
+ * inactive mode do not produce any events. When a mode becomes active again,
+ * its timers restart relative to the current tag.
+ */
+class Mode : public ReactorElement {
+ private:
+  std::set<Reaction*> _reactions;
+  std::set<Timer*> _timers;
+
+ public:
+  Mode(const std::string& name, Reactor* container);
+
+  void declare_reaction(Reaction* reaction);
+  void declare_timer(Timer* timer);
+
+  const auto& reactions() const { return _reactions; }
+  const auto& timers() const { return _timers; }
+
+  bool is_active() const { return container()->active_mode() == this; }
+
+  void startup() override final {}
+  void shutdown() override final {}
+};
+
+}  // namespace reactor
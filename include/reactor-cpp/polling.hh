@@ -0,0 +1,91 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <functional>
+#include <string>
+#include <type_traits>
+
+#include "action.hh"
+#include "environment.hh"
+#include "logical_time.hh"
+#include "scheduler.hh"
+#include "value_ptr.hh"
+
+namespace reactor {
+
+/**
+ * An action that receives values from a source that is polled by the
+ * scheduler, e.g., a shared memory ring or a non-blocking socket.
+ *
+ * The given function is called repeatedly by the worker that waits for the
+ * next tag, and it returns an empty pointer if there is no new value. Each
+ * value received is scheduled at the current physical time, or at the next
+ * possible microstep if that lies in the logical past. Thus, the action
+ * behaves like a physical action, but values are injected without involving
+ * another thread or waking up the scheduler.
+ *
+ * Note that the worker that waits for the next tag spins for as long as a
+ * polling action exists in the environment. All other idle workers block.
+ */
+template <class T>
+class PollingAction : public Action<T>, public Ingress {
+  static_assert(!std::is_void<T>::value,
+                "Polling actions require a value type");
+
+ public:
+  using PollFunction = std::function<MutableValuePtr<T>(void)>;
+
+ private:
+  const PollFunction poll;
+  // a value that was polled but not scheduled yet
+  mutable ImmutableValuePtr<T> polled{nullptr};
+  // the last tag assigned to a received value
+  LogicalTime last_tag{};
+
+ public:
+  PollingAction(const std::string& name, Reactor* container, PollFunction poll)
+      : Action<T>(name, container, false, Duration::zero())
+      , poll(std::move(poll)) {
+    this->environment()->scheduler()->register_ingress(this, true);
+  }
+
+  ~PollingAction() {
+    this->environment()->scheduler()->unregister_ingress(this);
+  }
+
+  // Polls for a new value and keeps it until drain() schedules it. This is
+  // safe as the scheduler only calls pending() and drain() from the worker
+  // that schedules the next tag (see Ingress).
+  bool pending() const override {
+    if (polled == nullptr) {
+      polled = ImmutableValuePtr<T>(poll());
+    }
+    return polled != nullptr;
+  }
+
+  void drain() override {
+    auto scheduler = this->environment()->scheduler();
+    while (pending()) {
+      // Each value needs its own tag as an action can only hold one value per
+      // tag.
+      auto now = Tag::from_logical_time(scheduler->logical_time());
+      auto last = Tag::from_logical_time(last_tag);
+      auto bound = last < now ? now : last;
+      auto time_point_tag = Tag::from_physical_time(get_physical_time());
+      auto tag = time_point_tag <= bound ? bound.delay() : time_point_tag;
+      last_tag.advance_to(tag);
+
+      this->schedule_at(std::move(polled), tag);
+      polled = nullptr;
+    }
+  }
+};
+
+}  // namespace reactor
@@ -8,7 +8,12 @@
 
 #pragma once
 
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
 #include <set>
+#include <vector>
 
 #include "reactor.hh"
 #include "value_ptr.hh"
@@ -20,23 +25,40 @@ enum class PortType { Input, Output };
 class BasePort : public ReactorElement {
  private:
   BasePort* _inward_binding = nullptr;
-  std::set<BasePort*> _outward_bindings;
+  // Each port can only have a single inward binding. Thus, no port can appear
+  // twice in the outward bindings and a compact vector is sufficient.
+  std::vector<BasePort*> _outward_bindings;
   const PortType type;
 
   std::set<Reaction*> _dependencies;
   std::set<Reaction*> _triggers;
   std::set<Reaction*> _antidependencies;
+  std::vector<Reaction*> _active_triggers;
 
  protected:
+  // Ports that set this flag are notified via record_history() whenever they
+  // become present.
+  bool records_history{false};
+
   BasePort(const std::string& name, PortType type, Reactor* container)
-      : ReactorElement(name, ReactorElement::Type::Port, container)
+      : ReactorElement(name,
+                       type == PortType::Input ? ReactorElement::Type::Input
+                                               : ReactorElement::Type::Output,
+                       container)
       , type(type) {}
 
   void base_bind_to(BasePort* port);
+  void base_unbind_from(BasePort* port);
+  static void base_bind_bulk(BasePort* const* from,
+                             std::size_t num_from,
+                             BasePort* const* to,
+                             std::size_t num_to,
+                             std::size_t group_size);
   void register_dependency(Reaction* reaction, bool is_trigger);
   void register_antidependency(Reaction* reaction);
 
   virtual void cleanup() = 0;
+  virtual void record_history() {}
 
  public:
   bool is_input() const { return type == PortType::Input; }
@@ -53,17 +75,55 @@ class BasePort : public ReactorElement {
   const auto& triggers() const { return _triggers; }
   const auto& dependencies() const { return _dependencies; }
   const auto& antidependencies() const { return _antidependencies; }
+  const auto& active_triggers() const { return _active_triggers; }
+
+  void update_active_triggers();
 
+  friend class Environment;
   friend class Reaction;
   friend class Scheduler;
 };
 
 template <class T>
 class Port : public BasePort {
+ protected:
+  // state of a value that is only computed when it is read for the first time
+  class LazyValue {
+   private:
+    std::mutex mutex;
+    std::function<T(void)> compute;
+    ImmutableValuePtr<T> value{nullptr};
+    std::atomic<bool> pending{false};
+
+    void evaluate();
+
+   public:
+    void reset(std::function<T(void)>&& compute);
+    void clear();
+    const ImmutableValuePtr<T>& get();
+
+    friend class Port<T>;
+  };
+
+  // the lazy value of the port that set the value of this port, if it is
+  // still pending
+  std::shared_ptr<LazyValue> pending_lazy_value() const;
+
  private:
   ImmutableValuePtr<T> value_ptr{nullptr};
-
-  void cleanup() override final { value_ptr = nullptr; }
+  // Allocated on the first call to set_lazy(). The lazy value may outlive
+  // the tag if a history port refers to it, in which case set_lazy()
+  // allocates a new one.
+  std::shared_ptr<LazyValue> lazy{nullptr};
+  bool is_lazy{false};
+
+  void cleanup() override final {
+    value_ptr = nullptr;
+    if (is_lazy && lazy.use_count() == 1) {
+      lazy->clear();
+    }
+    is_lazy = false;
+  }
 
  public:
   using value_type = T;
@@ -72,8 +132,21 @@ class Port : public BasePort {
       : BasePort(name, type, container) {}
 
   void bind_to(Port<T>* port) { base_bind_to(port); }
+  void bind_to(const std::vector<Port<T>*>& ports);
+  void unbind_from(Port<T>* port) { base_unbind_from(port); }
   Port<T>* typed_inward_binding() const;
-  const std::set<Port<T>*>& typed_outward_bindings() const;
+  const std::vector<Port<T>*>& typed_outward_bindings() const;
+
+  // Bulk bindings validate the binding rules once per pattern. For N ports in
+  // from, bind_one_to_each binds from[i] to to[i], bind_repeated binds
+  // from[i] to to[g * N + i] for each group g of N ports in to, and
+  // bind_interleaved binds from[i] to to[i * G + g] for G = to.size() / N.
+  static void bind_one_to_each(const std::vector<Port<T>*>& from,
+                               const std::vector<Port<T>*>& to);
+  static void bind_repeated(const std::vector<Port<T>*>& from,
+                            const std::vector<Port<T>*>& to);
+  static void bind_interleaved(const std::vector<Port<T>*>& from,
+                               const std::vector<Port<T>*>& to);
 
   void set(const ImmutableValuePtr<T>& value_ptr);
   void set(MutableValuePtr<T>&& value_ptr) {
@@ -84,6 +157,20 @@ class Port : public BasePort {
   // Setting a port to nullptr is not permitted.
   void set(std::nullptr_t) = delete;
 
+  /**
+   * Set the port to a value that is computed by the given function.
+   *
+   * The function is called at most once, by the first reader that calls
+   * get(), even if multiple reactions read the port concurrently. If no
+   * reaction reads the port in the current tag, the function is not called at
+   * all. The function is executed in the context of the reader and thus may
+   * only access state that is not modified by any other reaction in the
+   * current tag. If the value is recorded by a HistoryInput, the function
+   * may also be called when the history is read in a later tag and should
+   * capture all state it needs by value.
+   */
+  void set_lazy(std::function<T(void)> compute);
+
   void startup() override final {}
   void shutdown() override final {}
 
@@ -106,8 +193,17 @@ class Port<void> : public BasePort {
       : BasePort(name, type, container) {}
 
   void bind_to(Port<void>* port) { base_bind_to(port); }
+  void bind_to(const std::vector<Port<void>*>& ports);
+  void unbind_from(Port<void>* port) { base_unbind_from(port); }
   Port<void>* typed_inward_binding() const;
-  const std::set<Port<void>*>& typed_outward_bindings() const;
+  const std::vector<Port<void>*>& typed_outward_bindings() const;
+
+  static void bind_one_to_each(const std::vector<Port<void>*>& from,
+                               const std::vector<Port<void>*>& to);
+  static void bind_repeated(const std::vector<Port<void>*>& from,
+                            const std::vector<Port<void>*>& to);
+  static void bind_interleaved(const std::vector<Port<void>*>& from,
+                               const std::vector<Port<void>*>& to);
 
   void set();
   bool is_present() const;
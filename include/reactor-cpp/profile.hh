@@ -0,0 +1,77 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "fwd.hh"
+#include "logical_time.hh"
+#include "time.hh"
+
+namespace reactor {
+
+/**
+ * A log-linear histogram of durations.
+ *
+ * Each power of two is split into 16 buckets. Thus, reported percentiles
+ * have a relative error of at most about 6%, while the memory required is
+ * bounded independently of the number of recorded values.
+ */
+class DurationHistogram {
+ private:
+  std::vector<std::uint64_t> buckets{};
+  std::uint64_t _count{0};
+  Duration _total{Duration::zero()};
+  Duration _max{Duration::zero()};
+
+ public:
+  void add(Duration value);
+
+  std::uint64_t count() const { return _count; }
+  Duration max() const { return _max; }
+  Duration total() const { return _total; }
+  Duration mean() const;
+  /// p is given in percent
+  Duration percentile(double p) const;
+};
+
+/**
+ * Execution statistics of a reaction that are collected while profiling is
+ * enabled in the environment.
+ *
+ * For each tag, the critical path is the chain of dependencies that ends in
+ * the reaction finishing last, where each reaction is preceded by the
+ * dependency that finished last in the same tag.
+ */
+class ReactionProfile {
+ private:
+  DurationHistogram _execution_time{};
+  // number of tags in which this reaction was on the critical path
+  std::uint64_t _critical{0};
+  // number of tags in which the dependency on the given reaction was on the
+  // critical path
+  std::map<const Reaction*, std::uint64_t> _critical_dependencies{};
+
+  // state of the most recent execution
+  TimePoint tag_time_point{};
+  mstep_t tag_micro_step{0};
+  TimePoint finish{};
+  Reaction* critical_predecessor{nullptr};
+
+ public:
+  const DurationHistogram& execution_time() const { return _execution_time; }
+  std::uint64_t critical() const { return _critical; }
+  std::uint64_t critical(const Reaction* dependency) const;
+
+  friend Environment;
+};
+
+}  // namespace reactor
@@ -11,6 +11,7 @@
 #include <functional>
 #include <set>
 
+#include "profile.hh"
 #include "reactor.hh"
 
 namespace reactor {
@@ -25,6 +26,14 @@ class Reaction : public ReactorElement {
 
   const int _priority;
   unsigned _index;
+  Mode* _mode{nullptr};
+
+  bool _pure{false};
+  bool _pruned{false};
+
+  bool _partitioned{false};
+  unsigned _state_partition{0};
+  bool _changes_mode{false};
 
   std::function<void(void)> body;
 
@@ -33,6 +42,8 @@ class Reaction : public ReactorElement {
 
   void set_deadline_impl(Duration deadline, std::function<void(void)> handler);
 
+  ReactionProfile _profile{};
+
  public:
   Reaction(const std::string& name,
            int priority,
@@ -47,6 +58,45 @@ class Reaction : public ReactorElement {
   void declare_antidependency(BasePort* port);
   void declare_dependency(BasePort* port);
 
+  /**
+   * Declare that the reaction has no effects other than setting its
+   * antidependencies and scheduling its schedulable actions, i.e., it neither
+   * modifies state that is read by other reactions nor interacts with the
+   * outside world.
+   *
+   * At startup, pure reactions whose effects cannot be observed by any other
+   * reaction are pruned from the program and never execute. This is the case
+   * if their ports are not read and their actions do not trigger any
+   * reaction that is not pruned itself. A mutation that makes the effects of
+   * a pruned reaction observable restores the reaction.
+   */
+  void declare_pure();
+
+  /**
+   * Declare that the reaction only accesses the given partition of the
+   * state of its reactor.
+   *
+   * Reactions of the same reactor are executed in the order of their
+   * priority. This order is not enforced between reactions that belong to
+   * different partitions, unless they set the same port or schedule the same
+   * action. Thus, they may execute concurrently. Reactions that do not
+   * declare a partition may access the entire state and are ordered with
+   * respect to all other reactions. Changing the mode of the reactor
+   * accesses the entire state, see declare_mode_change().
+   */
+  void declare_state_partition(unsigned partition);
+
+  /**
+   * Declare that the reaction may change the mode of its reactor.
+   *
+   * Only reactions that declared this may call Reactor::set_mode(). A
+   * reaction that changes modes is ordered with respect to all other
+   * reactions of its reactor that may execute at the same tag, even if it
+   * declares a state partition. Thus, no two reactions change the mode of
+   * the same reactor concurrently.
+   */
+  void declare_mode_change();
+
   const auto& action_triggers() const { return _action_triggers; }
   const auto& port_triggers() const { return _port_triggers; }
   const auto& antidependencies() const { return _antidependencies; }
@@ -54,6 +104,17 @@ class Reaction : public ReactorElement {
   const auto& scheduable_actions() const { return _scheduable_actions; }
 
   int priority() const { return _priority; }
+  Mode* mode() const { return _mode; }
+  bool is_active() const;
+  bool is_pure() const { return _pure; }
+  bool is_pruned() const { return _pruned; }
+  bool is_partitioned() const { return _partitioned; }
+  unsigned state_partition() const { return _state_partition; }
+  bool changes_mode() const { return _changes_mode; }
+
+  /// Check if the reaction needs to be ordered with the given reaction of
+  /// the same reactor.
+  bool conflicts_with(const Reaction* reaction) const;
 
   void startup() override final {}
   void shutdown() override final {}
@@ -68,6 +129,11 @@ class Reaction : public ReactorElement {
 
   void set_index(unsigned index);
   unsigned index() const { return _index; }
+
+  const ReactionProfile& profile() const { return _profile; }
+
+  friend Environment;
+  friend Mode;
 };
 
 }  // namespace reactor
@@ -9,10 +9,25 @@
 #pragma once
 
 // include everything that is needed to use reactor-cpp
+#include "config.hh"
+
 #include "action.hh"
+#include "channel.hh"
+#include "enclave.hh"
 #include "environment.hh"
+#include "flight_recorder.hh"
+#include "history.hh"
 #include "logical_time.hh"
+#include "mode.hh"
+#include "polling.hh"
 #include "port.hh"
+#include "profile.hh"
 #include "reaction.hh"
 #include "reactor.hh"
+#include "scheduling_policy.hh"
+#include "stream.hh"
 #include "time.hh"
+
+#ifdef REACTOR_CPP_SHARED_MEMORY
+#include "shared_memory.hh"
+#endif
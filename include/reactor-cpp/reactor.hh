@@ -14,12 +14,13 @@
 
 #include "fwd.hh"
 #include "time.hh"
+#include "trace_filter_cache.hh"
 
 namespace reactor {
 
 class ReactorElement {
  public:
-  enum class Type { Action, Port, Reaction, Reactor };
+  enum class Type { Action, Input, Mode, Output, Reaction, Reactor };
 
  private:
   const std::string _name;
@@ -30,6 +31,8 @@ class ReactorElement {
 
   Environment* _environment;
 
+  TraceFilterCache _trace_filter_cache{};
+
   std::stringstream& fqn_detail(std::stringstream& ss) const;
 
  public:
@@ -51,6 +54,8 @@ class ReactorElement {
 
   virtual void startup() = 0;
   virtual void shutdown() = 0;
+
+  friend class TraceFilter;
 };
 
 class Reactor : public ReactorElement {
@@ -60,9 +65,14 @@ class Reactor : public ReactorElement {
   std::set<BasePort*> _outputs;
   std::set<Reaction*> _reactions;
   std::set<Reactor*> _reactors;
+  std::set<Mode*> _modes;
+
+  Mode* _active_mode{nullptr};
+  Mode* _next_mode{nullptr};
 
   void register_action(BaseAction* action);
-  void register_port(BasePort* port);
+  void register_mode(Mode* mode);
+  void register_port(BasePort* port, Type type);
   void register_reaction(Reaction* reaction);
   void register_reactor(Reactor* reactor);
 
@@ -76,6 +86,17 @@ class Reactor : public ReactorElement {
   const auto& outputs() const { return _outputs; }
   const auto& reactions() const { return _reactions; }
   const auto& reactors() const { return _reactors; }
+  const auto& modes() const { return _modes; }
+
+  Mode* active_mode() const { return _active_mode; }
+  /**
+   * Switch to the given mode after the current tag was processed. This may
+   * only be called by reactions of this reactor that declared a mode change,
+   * see Reaction::declare_mode_change().
+   */
+  void set_mode(Mode* mode);
+  void update_active_triggers();
+  void apply_mode_change();
 
   void startup() override final;
   void shutdown() override final;
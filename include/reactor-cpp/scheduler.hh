@@ -8,10 +8,13 @@
 
 #pragma once
 
+#include <atomic>
 #include <condition_variable>
+#include <cstdint>
 #include <functional>
 #include <future>
 #include <map>
+#include <memory>
 #include <mutex>
 #include <set>
 #include <thread>
@@ -19,6 +22,7 @@
 
 #include "fwd.hh"
 #include "logical_time.hh"
+#include "scheduling_policy.hh"
 #include "semaphore.hh"
 
 namespace reactor {
@@ -34,6 +38,8 @@ class Worker {
   std::thread thread;
 
   static thread_local const Worker* current_worker;
+  // the reaction that is executed by the current thread, if any
+  static thread_local const Reaction* current_reaction;
 
   void work() const;
   void execute_reaction(Reaction* reaction) const;
@@ -50,6 +56,76 @@ class Worker {
   static unsigned current_worker_id() { return current_worker->id; }
 };
 
+/**
+ * A source of events that is external to the environment, e.g., a channel
+ * from another environment.
+ *
+ * The scheduler drains all registered ingresses in between two tags. While
+ * the scheduler waits for physical time or new events, ingresses can wake it
+ * up by calling `Scheduler::notify_ingress()`.
+ *
+ * Alternatively, ingresses can be registered as polled. As long as there is
+ * any polled ingress, the worker that waits for the next tag does not block
+ * but spins on `pending()` of all ingresses. This avoids the wake-up latency
+ * at the cost of keeping one core busy. All other idle workers still block.
+ */
+class Ingress {
+ public:
+  virtual ~Ingress() {}
+
+  /// Check if there are events to be drained. This is only called by the
+  /// worker that schedules the next tag, but concurrently to the threads that
+  /// produce events for this ingress. Thus, it needs to synchronize with those
+  /// threads, but may have side effects that only the scheduling worker
+  /// observes, e.g., keeping a value that was polled until drain() is called.
+  virtual bool pending() const = 0;
+  /// Insert all available events into the event queue of the scheduler. This
+  /// is only called by the worker that schedules the next tag.
+  virtual void drain() = 0;
+};
+
+/**
+ * Callbacks that the scheduler invokes at tag boundaries, e.g., to flush side
+ * effects that reactions buffered during a tag in one batched operation.
+ *
+ * All callbacks are invoked by the worker that does the scheduling, while no
+ * reactions are executing. Thus, they may safely access the state of
+ * reactors. Hooks may only be registered and unregistered when the scheduler
+ * is not running or during a mutation.
+ */
+class TagHook {
+ public:
+  virtual ~TagHook() {}
+
+  /// Called after logical time advanced and before any reaction executes.
+  virtual void tag_starts(const LogicalTime&) {}
+  /// Called after all reactions of the current tag completed.
+  virtual void tag_finishes(const LogicalTime&) {}
+  /// Called once before the scheduler waits for physical time to reach the
+  /// next tag or for new events. In fast forward mode, the scheduler never
+  /// waits for physical time, and this is only called when a program that
+  /// runs forever waits for new events on an empty event queue.
+  virtual void before_sleep() {}
+};
+
+/**
+ * Runs tasks on threads that are not owned by the runtime, e.g., the thread
+ * pool of the host application.
+ *
+ * If an environment is given an executor, ready reactions are executed in
+ * tasks submitted to the executor instead of on the environment's own worker
+ * threads. The number of workers of the environment then limits how many
+ * tasks execute reactions concurrently.
+ */
+class Executor {
+ public:
+  virtual ~Executor() {}
+
+  /// Run the given task on any thread. This needs to be thread-safe. The task
+  /// may also be run synchronously on the calling thread.
+  virtual void execute(std::function<void(void)> task) = 0;
+};
+
 class ReadyQueue {
  private:
   std::vector<Reaction*> queue{};
@@ -85,6 +161,7 @@ class ReadyQueue {
 class Scheduler {
  public:
   using EventMap = std::map<BaseAction*, std::function<void(void)>>;
+  using EventList = std::vector<std::pair<Tag, std::function<void(void)>>>;
 
  private:
   const bool using_workers;
@@ -97,27 +174,113 @@ class Scheduler {
   std::unique_lock<std::mutex> schedule_lock{m_schedule, std::defer_lock};
   std::condition_variable cv_schedule;
 
-  std::mutex m_event_queue;
+  struct ScheduledEvent {
+    Tag tag;
+    BaseAction* action;
+    std::function<void(void)> setup;
+  };
+
+  // The event queue is only accessed by the scheduler in between two tags (or
+  // by the only worker). If there are multiple workers, they stage the events
+  // they schedule in their own buffer. Events scheduled by any other thread
+  // are collected in the async event queue, which is protected by m_schedule.
+  // The scheduler collects both before advancing to the next tag. Thus,
+  // scheduling an event does not require any locking unless it originates
+  // from outside of the workers, and the scheduler can advance to the next
+  // tag without acquiring m_schedule in fast forward mode.
+  //
+  // Whether m_schedule is needed is decided before each tag by checking if
+  // any other thread scheduled events, requested a mutation or stopped the
+  // execution. A check at startup for the absence of physical actions and
+  // ingresses could not replace this, as any program may be shut down or
+  // mutated by other threads, and mutations may add physical actions. A
+  // program without such sources never fails the check, so that m_schedule
+  // is only acquired once to collect the events scheduled at startup.
   std::map<Tag, EventMap> event_queue;
+  std::vector<std::vector<ScheduledEvent>> scheduled_events;
+  std::map<Tag, EventMap> async_event_queue;
+  std::atomic<bool> async_events_pending{false};
+
+  // In fast forward mode, the scheduler moves several consecutive tags out of
+  // the event queue at once and takes the following tags from this batch.
+  // Events that are scheduled in the meantime remain in the event queue and
+  // are considered before each batched tag is processed.
+  static constexpr std::size_t tag_batch_size{64};
+  std::vector<std::pair<Tag, EventMap>> tag_batch{};
+  std::size_t tag_batch_pos{0};
+
+  // the events of the tag currently being processed
+  EventMap events{};
+  // the physical time as of the last time the scheduler checked it
+  TimePoint physical_time{TimePoint::min()};
 
   std::vector<std::vector<BasePort*>> set_ports;
+  std::vector<std::vector<Reactor*>> mode_changes;
   std::vector<std::vector<Reaction*>> triggered_reactions;
 
-  std::vector<std::vector<Reaction*>> reaction_queue;
-  unsigned reaction_queue_pos{std::numeric_limits<unsigned>::max()};
+  std::vector<Ingress*> ingresses;
+  std::vector<Ingress*> polled_ingresses;
+
+  std::vector<TagHook*> tag_hooks;
+  bool tag_in_progress{false};
+  std::atomic<bool> waiting_for_events{false};
+
+  std::unique_ptr<SchedulingPolicy> policy;
+  std::vector<Reaction*> ready_reactions{};
+  // identifier and number of reactions of the level currently being processed
+  unsigned level{0};
+  unsigned level_width{0};
 
   ReadyQueue ready_queue;
   std::atomic<std::ptrdiff_t> reactions_to_process{0};
+  // the reaction that completed the level currently being processed
+  Reaction* last_reaction{nullptr};
+
+  // State for executing reactions on an external executor. The ready
+  // reactions of the current level are claimed via a cursor that holds the
+  // number of reactions in its upper and the index of the next unclaimed
+  // reaction in its lower 32 bits. Each task claims one of the workers to act
+  // on its behalf, so that the per-worker state remains exclusive.
+  Executor* executor{nullptr};
+  std::vector<Reaction*> executor_queue{};
+  std::atomic<std::uint64_t> executor_cursor{0};
+  std::mutex m_executor;
+  std::condition_variable cv_executor;
+  std::vector<unsigned> idle_workers{};
+  std::size_t active_tasks{0};
+  bool executor_terminated{false};
+
+  void start_on_executor();
+  void dispatch_to_executor(std::vector<Reaction*>& ready_reactions);
+  void run_task(bool initial);
+  void execute_task(bool initial);
+  Reaction* claim_reaction();
 
   void schedule();
   bool schedule_ready_reactions();
 
   void next();
+  void collect_scheduled_events();
+  void merge_async_events();
+  void fill_tag_batch();
+  void return_tag_batch();
+  bool advance_to_batched_tag();
+
+  void trace_tag_advance(const Tag& tag) const;
+  void trace_sleep_starts(const TimePoint& until) const;
+  void trace_sleep_finishes() const;
 
   void terminate_all_workers();
 
   void set_port_helper(BasePort* p);
 
+  bool ingress_pending() const;
+  void drain_ingresses();
+  bool poll_until(std::unique_lock<std::mutex>& lock, const TimePoint& until);
+
+  void finish_tag();
+  bool invoke_sleep_hooks(std::unique_lock<std::mutex>& lock);
+
   std::atomic<bool> _stop{false};
   bool continue_execution{true};
 
@@ -131,11 +294,31 @@ class Scheduler {
   void schedule_async(const Tag& tag,
                       BaseAction* action,
                       std::function<void(void)> pre_handler);
+  /**
+   * Schedule an action at multiple tags at once. The events are sorted and
+   * inserted in one pass. If there are multiple events with the same tag, the
+   * last one takes effect. The list is left in an unspecified state.
+   */
+  void schedule_sync(BaseAction* action, EventList& events);
+
+  void set_executor(Executor* executor) { this->executor = executor; }
+  void set_policy(std::unique_ptr<SchedulingPolicy> policy) {
+    this->policy = std::move(policy);
+  }
 
   void lock() { schedule_lock.lock(); }
   void unlock() { schedule_lock.unlock(); }
 
+  void notify();
+  void notify_ingress();
+  void register_ingress(Ingress* ingress, bool polled = false);
+  void unregister_ingress(Ingress* ingress);
+  void register_tag_hook(TagHook* hook);
+  void unregister_tag_hook(TagHook* hook);
+  void remove_events(const std::set<BaseAction*>& actions);
+
   void set_port(BasePort*);
+  void register_mode_change(Reactor* reactor);
 
   const LogicalTime& logical_time() const { return _logical_time; }
 
@@ -0,0 +1,111 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "fwd.hh"
+
+namespace reactor {
+
+/**
+ * Decides which of the reactions triggered at the current tag are executed
+ * next.
+ *
+ * The scheduler processes each tag in batches. It passes all triggered
+ * reactions to the policy and requests the next batch of ready reactions,
+ * which are executed concurrently by the workers. Only when all reactions of
+ * a batch completed, the scheduler requests the next one. Thus, a policy
+ * needs to ensure that all reactions in a batch are independent of each
+ * other and of any reaction that is still to be executed at the current tag.
+ *
+ * The methods of a policy are only called by one thread at a time.
+ */
+class SchedulingPolicy {
+ public:
+  virtual ~SchedulingPolicy() {}
+
+  /// Called before the execution starts and after each topology mutation.
+  virtual void update(const Environment& environment) = 0;
+
+  /// Add a reaction that was triggered at the current tag. A reaction may be
+  /// triggered multiple times.
+  virtual void trigger(Reaction* reaction) = 0;
+
+  /**
+   * Move the next batch of ready reactions to `ready`, which is empty when
+   * this method is called. `level` is set to an identifier of the batch that
+   * is used for tracing. Return false if there are no more reactions to be
+   * executed at the current tag.
+   */
+  virtual bool next_ready(std::vector<Reaction*>& ready, unsigned& level) = 0;
+};
+
+/**
+ * Executes the triggered reactions level by level, where the level of a
+ * reaction is its index in the dependency graph. This is the default policy.
+ */
+class LevelPolicy : public SchedulingPolicy {
+ private:
+  std::vector<std::vector<Reaction*>> reaction_queue{};
+  unsigned reaction_queue_pos{0};
+
+ public:
+  void update(const Environment& environment) override;
+  void trigger(Reaction* reaction) override;
+  bool next_ready(std::vector<Reaction*>& ready, unsigned& level) override;
+};
+
+/**
+ * Executes each triggered reaction as soon as none of the reactions it
+ * transitively depends on is still to be executed at the current tag.
+ *
+ * Other than the level policy, this allows reactions of different levels to
+ * execute concurrently, which results in fewer and wider batches if the
+ * dependency graph is unbalanced. The policy keeps the set of transitive
+ * dependencies of each reaction, which requires memory quadratic in the
+ * number of reactions.
+ */
+class DependencyPolicy : public SchedulingPolicy {
+ private:
+  using Bits = std::vector<std::uint64_t>;
+
+  std::unordered_map<const Reaction*, std::size_t> ids{};
+  // transitive dependencies of each reaction, indexed by the reaction's id
+  std::vector<Bits> upstream{};
+  // reactions that are triggered but not executed yet, along with their ids
+  std::vector<std::pair<Reaction*, std::size_t>> pending{};
+  Bits pending_bits{};
+  unsigned batch{0};
+
+ public:
+  void update(const Environment& environment) override;
+  void trigger(Reaction* reaction) override;
+  bool next_ready(std::vector<Reaction*>& ready, unsigned& level) override;
+};
+
+/**
+ * Executes the triggered reactions one at a time in the order of their
+ * indexes. This avoids any concurrency within a tag and yields the same
+ * order of execution in each run, which helps with debugging.
+ */
+class SequentialPolicy : public LevelPolicy {
+ private:
+  std::vector<Reaction*> batch{};
+  std::size_t batch_pos{0};
+  unsigned batch_level{0};
+
+ public:
+  bool next_ready(std::vector<Reaction*>& ready, unsigned& level) override;
+};
+
+}  // namespace reactor
@@ -0,0 +1,292 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "assert.hh"
+#include "value_ptr.hh"
+
+namespace reactor {
+
+template <class T>
+class SharedValueView;
+
+/**
+ * A named shared memory segment that values can be allocated from.
+ *
+ * Values allocated from an arena can be read in place by other processes that
+ * attach to the same arena, without any serialization. Within the segment,
+ * values are addressed by their offset to the segment start, as the segment
+ * is mapped to different addresses in different processes. Each value carries
+ * a process-shared reference count. The value pointers of the creating
+ * process together hold a single reference, and each view held by an
+ * observing process holds another one. The memory is returned to the arena
+ * when the last reference is dropped, regardless of which process drops it.
+ *
+ * Since the last reference may be dropped in a process that did not create
+ * the value, only trivially copyable values can be allocated from an arena.
+ *
+ * The process that creates the arena owns it and removes the name when the
+ * arena is destroyed. All values allocated from an arena need to be released
+ * before the arena is destroyed.
+ *
+ * Values are handed to observers via a fixed number of slots. The producer
+ * publishes a value in a slot and an observer obtains a view of the value
+ * that is currently published in a slot.
+ *
+ * The allocator state and the slots are protected by a spinlock in the
+ * shared segment, which is only held for a few instructions. If a process
+ * dies while holding it, all other processes block forever on their next
+ * access to the arena. The lock is not robust against this, so processes
+ * sharing an arena should only be terminated in between accesses, e.g., by
+ * handling signals in the program instead of using the default action.
+ */
+class SharedMemoryArena {
+ public:
+  /// The number of slots that values can be published in
+  static constexpr std::size_t num_slots{64};
+
+ private:
+  struct Header;
+  struct Block;
+
+  const std::string _name;
+  const bool _owner;
+  std::size_t _size{0};
+  Header* header{nullptr};
+
+  unsigned char* base() const {
+    return reinterpret_cast<unsigned char*>(header);
+  }
+  Block* block_of(const void* value) const;
+  static std::size_t header_size();
+
+  void lock() const;
+  void unlock() const;
+
+  void publish_value(std::size_t slot, const void* value);
+  const void* observe_value(std::size_t slot, std::size_t size);
+
+ public:
+  /**
+   * Create a new arena of the given size and register it under the given
+   * name. The name must start with a slash and must not exist yet.
+   */
+  SharedMemoryArena(const std::string& name, std::size_t size);
+  /**
+   * Attach to an arena that was created by another process.
+   */
+  explicit SharedMemoryArena(const std::string& name);
+  ~SharedMemoryArena();
+
+  SharedMemoryArena(const SharedMemoryArena&) = delete;
+  SharedMemoryArena& operator=(const SharedMemoryArena&) = delete;
+
+  const std::string& name() const { return _name; }
+  std::size_t size() const { return _size; }
+  bool is_owner() const { return _owner; }
+
+  /**
+   * Allocate memory for a value of the given size. The returned memory is
+   * aligned to alignof(std::max_align_t) and holds a single reference.
+   * Throws std::bad_alloc if the arena is exhausted or if the size exceeds
+   * the largest block that an arena supports.
+   */
+  void* allocate(std::size_t size);
+  /// Take an additional reference to a value allocated from this arena
+  void retain(const void* value);
+  /// Drop a reference to a value allocated from this arena
+  void release(const void* value);
+
+  /// Translate an address within the arena to an offset
+  std::size_t offset_of(const void* value) const;
+  /// Translate an offset to an address within the arena
+  const void* address_of(std::size_t offset) const;
+  /// Check if the given address points into this arena
+  bool contains(const void* value) const;
+
+  /**
+   * Publish a value in the given slot. The value must be allocated from this
+   * arena. The slot holds a reference to the value until it is replaced.
+   */
+  template <class T>
+  void publish(std::size_t slot, const ImmutableValuePtr<T>& value) {
+    publish_value(slot, value.get());
+  }
+  /// Remove the value from the given slot
+  void clear(std::size_t slot) { publish_value(slot, nullptr); }
+
+  /**
+   * Obtain a view of the value currently published in the given slot. The
+   * view is empty if there is no value in the slot.
+   */
+  template <class T>
+  SharedValueView<T> observe(std::size_t slot) {
+    return SharedValueView<T>(
+        this, static_cast<const T*>(observe_value(slot, sizeof(T))));
+  }
+};
+
+/**
+ * Read-only view of a value that lives in a shared memory arena.
+ *
+ * A view holds a reference to the value, which keeps the value alive even if
+ * the producing process drops it. Copying a view takes another reference.
+ */
+template <class T>
+class SharedValueView {
+ private:
+  SharedMemoryArena* arena{nullptr};
+  const T* value{nullptr};
+
+  SharedValueView(SharedMemoryArena* arena, const T* value)
+      : arena(arena), value(value) {}
+
+ public:
+  SharedValueView() = default;
+  SharedValueView(const SharedValueView& view)
+      : arena(view.arena), value(view.value) {
+    if (value != nullptr) {
+      arena->retain(value);
+    }
+  }
+  SharedValueView(SharedValueView&& view)
+      : arena(view.arena), value(view.value) {
+    view.value = nullptr;
+  }
+  ~SharedValueView() { reset(); }
+
+  SharedValueView& operator=(SharedValueView view) {
+    std::swap(arena, view.arena);
+    std::swap(value, view.value);
+    return *this;
+  }
+
+  void reset() {
+    if (value != nullptr) {
+      arena->release(value);
+      value = nullptr;
+    }
+  }
+
+  const T* get() const { return value; }
+  const T& operator*() const { return *value; }
+  const T* operator->() const { return value; }
+  explicit operator bool() const { return value != nullptr; }
+
+  friend class SharedMemoryArena;
+};
+
+/**
+ * Smart pointer to a mutable value that lives in a shared memory arena.
+ *
+ * Like `MutableValuePtr`, an arena value pointer has unique ownership of its
+ * value, which may be written in place before it is converted to an
+ * `ImmutableValuePtr` to be shared or published. It is a separate type, so
+ * that the value pointers of values allocated with `new` do not need to
+ * carry a deleter.
+ */
+template <class T>
+class ArenaValuePtr {
+ private:
+  struct Deleter {
+    SharedMemoryArena* arena;
+    void operator()(T* value) const {
+      value->~T();
+      arena->release(value);
+    }
+  };
+
+  SharedMemoryArena* arena{nullptr};
+  T* value{nullptr};
+
+  ArenaValuePtr(SharedMemoryArena* arena, T* value)
+      : arena(arena), value(value) {}
+
+ public:
+  ArenaValuePtr() = default;
+  ArenaValuePtr(const ArenaValuePtr&) = delete;
+  ArenaValuePtr(ArenaValuePtr&& ptr) : arena(ptr.arena), value(ptr.value) {
+    ptr.value = nullptr;
+  }
+  ~ArenaValuePtr() { reset(); }
+
+  ArenaValuePtr& operator=(ArenaValuePtr&& ptr) {
+    if (this != &ptr) {
+      reset();
+      std::swap(arena, ptr.arena);
+      std::swap(value, ptr.value);
+    }
+    return *this;
+  }
+
+  void reset() {
+    if (value != nullptr) {
+      Deleter{arena}(value);
+      value = nullptr;
+    }
+  }
+
+  T* get() const { return value; }
+  T& operator*() const { return *value; }
+  T* operator->() const { return value; }
+  explicit operator bool() const { return value != nullptr; }
+
+  template <class U, class... Args>
+  friend ArenaValuePtr<U> make_mutable_value(SharedMemoryArena& arena,
+                                             Args&&... args);
+  friend class ImmutableValuePtr<T>;
+};
+
+/**
+ * @rst
+ * Create an instance of :class:`ArenaValuePtr` whose value is allocated from
+ * a :class:`SharedMemoryArena`.
+ * @endrst
+ */
+template <class T, class... Args>
+ArenaValuePtr<T> make_mutable_value(SharedMemoryArena& arena,
+                                    Args&&... args) {
+  static_assert(std::is_trivially_copyable<T>::value,
+                "Only trivially copyable values can be shared across "
+                "processes");
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "Over-aligned values are not supported by shared memory "
+                "arenas");
+  void* memory = arena.allocate(sizeof(T));
+  T* value{nullptr};
+  try {
+    value = new (memory) T(std::forward<Args>(args)...);
+  } catch (...) {
+    arena.release(memory);
+    throw;
+  }
+  return ArenaValuePtr<T>(&arena, value);
+}
+
+/**
+ * @rst
+ * Create an instance of :class:`ImmutableValuePtr` whose value is allocated
+ * from a :class:`SharedMemoryArena`.
+ * @endrst
+ */
+template <class T, class... Args>
+ImmutableValuePtr<T> make_immutable_value(SharedMemoryArena& arena,
+                                          Args&&... args) {
+  return ImmutableValuePtr<T>(
+      make_mutable_value<T>(arena, std::forward<Args>(args)...));
+}
+
+}  // namespace reactor
@@ -0,0 +1,170 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include "assert.hh"
+#include "environment.hh"
+#include "port.hh"
+
+namespace reactor {
+
+/**
+ * A fixed-capacity batch of samples.
+ *
+ * The samples are aligned to 64 bytes, which is sufficient for any SIMD
+ * instruction set and corresponds to the typical cache line size. The batch
+ * provides span-style access to the valid samples.
+ */
+template <class T, std::size_t Capacity>
+class alignas(64) SampleBatch {
+  static_assert(Capacity > 0, "Sample batches require a non-zero capacity");
+
+ private:
+  T samples[Capacity];
+  std::size_t _size{0};
+
+ public:
+  using value_type = T;
+
+  T* data() { return samples; }
+  const T* data() const { return samples; }
+
+  std::size_t size() const { return _size; }
+  static constexpr std::size_t capacity() { return Capacity; }
+  bool empty() const { return _size == 0; }
+
+  void resize(std::size_t size) {
+    reactor::validate(size <= Capacity,
+             "Sample batches cannot grow beyond their capacity!");
+    _size = size;
+  }
+
+  T& operator[](std::size_t i) { return samples[i]; }
+  const T& operator[](std::size_t i) const { return samples[i]; }
+
+  T* begin() { return samples; }
+  T* end() { return samples + _size; }
+  const T* begin() const { return samples; }
+  const T* end() const { return samples + _size; }
+};
+
+/**
+ * A port that carries batches of samples.
+ *
+ * In contrast to `Port<std::vector<T>>`, a stream port does not allocate
+ * memory for each value. The port that is set owns a ring of recycled
+ * batches. A writer acquires the next batch of the ring, fills it in place
+ * and sets the port. Readers access the batch without copying it. A batch
+ * stays valid for `depth - 1` tags after the tag it was set at, before it is
+ * reused by the writer.
+ */
+template <class T, std::size_t Capacity>
+class StreamPort : public BasePort {
+ public:
+  using batch_type = SampleBatch<T, Capacity>;
+
+ private:
+  std::vector<batch_type> ring;
+  const std::size_t depth;
+  std::size_t next{0};
+  // whether ring[next] was acquired but not yet set
+  bool acquired{false};
+  const batch_type* current{nullptr};
+
+  void cleanup() override final { current = nullptr; }
+
+ public:
+  StreamPort(const std::string& name,
+             PortType type,
+             Reactor* container,
+             std::size_t depth)
+      : BasePort(name, type, container), depth(depth) {
+    reactor::validate(depth > 0, "Stream ports require a non-zero depth!");
+  }
+
+  void bind_to(StreamPort<T, Capacity>* port) { base_bind_to(port); }
+  StreamPort<T, Capacity>* typed_inward_binding() const {
+    return static_cast<StreamPort<T, Capacity>*>(inward_binding());
+  }
+
+  /**
+   * Acquire the batch to be written next.
+   *
+   * The batch is empty when it is first acquired. Repeated calls return the
+   * same batch, including the samples written so far, until the port is set.
+   * The ring of batches is allocated on the first call.
+   */
+  batch_type& acquire() {
+    reactor::validate(!has_inward_binding(),
+             "acquire() may only be called on a ports that do not have an "
+             "inward binding!");
+    if (ring.empty()) {
+      ring.resize(depth);
+    }
+    auto& batch = ring[next];
+    if (!acquired) {
+      batch.resize(0);
+      acquired = true;
+    }
+    return batch;
+  }
+
+  /// Set the port to the batch previously returned by acquire().
+  void set() {
+    reactor::validate(acquired, "set() requires a previously acquired batch!");
+    acquired = false;
+    current = &ring[next];
+    next = (next + 1) % depth;
+    environment()->scheduler()->set_port(this);
+  }
+
+  const batch_type& get() const {
+    if (has_inward_binding()) {
+      return typed_inward_binding()->get();
+    } else {
+      reactor::validate(current != nullptr,
+               "get() may only be called on ports that are present!");
+      return *current;
+    }
+  }
+
+  bool is_present() const {
+    if (has_inward_binding()) {
+      return typed_inward_binding()->is_present();
+    } else {
+      return current != nullptr;
+    }
+  }
+
+  void startup() override final {}
+  void shutdown() override final {}
+};
+
+template <class T, std::size_t Capacity>
+class StreamInput : public StreamPort<T, Capacity> {
+ public:
+  StreamInput(const std::string& name,
+              Reactor* container,
+              std::size_t depth = 2)
+      : StreamPort<T, Capacity>(name, PortType::Input, container, depth) {}
+};
+
+template <class T, std::size_t Capacity>
+class StreamOutput : public StreamPort<T, Capacity> {
+ public:
+  StreamOutput(const std::string& name,
+               Reactor* container,
+               std::size_t depth = 2)
+      : StreamPort<T, Capacity>(name, PortType::Output, container, depth) {}
+};
+
+}  // namespace reactor
@@ -92,6 +92,120 @@ TRACEPOINT_EVENT(
   )
 )
 
+TRACEPOINT_EVENT(
+  reactor_cpp,
+  tag_advance,
+  TP_ARGS(
+    const reactor::Tag&, tag_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(unsigned long, timestamp_ns,
+                tag_arg.time_point().time_since_epoch().count())
+    ctf_integer(unsigned, timestamp_microstep, tag_arg.micro_step())
+  )
+)
+
+TRACEPOINT_EVENT_CLASS(
+  reactor_cpp,
+  level,
+  TP_ARGS(
+    int, worker_id_arg,
+    unsigned, level_arg,
+    unsigned, width_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(int, worker_id, worker_id_arg)
+    ctf_integer(unsigned, level, level_arg)
+    ctf_integer(unsigned, width, width_arg)
+  )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+  reactor_cpp,
+  level,
+  level_starts,
+  TP_ARGS(
+    int, worker_id_arg,
+    unsigned, level_arg,
+    unsigned, width_arg
+  )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+  reactor_cpp,
+  level,
+  level_finishes,
+  TP_ARGS(
+    int, worker_id_arg,
+    unsigned, level_arg,
+    unsigned, width_arg
+  )
+)
+
+TRACEPOINT_EVENT(
+  reactor_cpp,
+  physical_time_sleep_starts,
+  TP_ARGS(
+    int, worker_id_arg,
+    const reactor::TimePoint&, until_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(int, worker_id, worker_id_arg)
+    ctf_integer(unsigned long, until_ns, until_arg.time_since_epoch().count())
+  )
+)
+
+TRACEPOINT_EVENT_CLASS(
+  reactor_cpp,
+  worker,
+  TP_ARGS(
+    int, worker_id_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(int, worker_id, worker_id_arg)
+  )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+  reactor_cpp,
+  worker,
+  physical_time_sleep_finishes,
+  TP_ARGS(
+    int, worker_id_arg
+  )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+  reactor_cpp,
+  worker,
+  worker_parks,
+  TP_ARGS(
+    int, worker_id_arg
+  )
+)
+
+TRACEPOINT_EVENT_INSTANCE(
+  reactor_cpp,
+  worker,
+  worker_unparks,
+  TP_ARGS(
+    int, worker_id_arg
+  )
+)
+
+TRACEPOINT_EVENT(
+  reactor_cpp,
+  ingress_drain,
+  TP_ARGS(
+    int, worker_id_arg,
+    unsigned, num_ingresses_arg
+  ),
+  TP_FIELDS(
+    ctf_integer(int, worker_id, worker_id_arg)
+    ctf_integer(unsigned, num_ingresses, num_ingresses_arg)
+  )
+)
+
 #endif /* _REACTOR_CPP_TRACE_H */
 
 #include <lttng/tracepoint-event.h>
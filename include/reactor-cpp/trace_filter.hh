@@ -0,0 +1,177 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "fwd.hh"
+#include "time.hh"
+#include "trace.hh"
+#include "trace_filter_cache.hh"
+
+namespace reactor {
+
+class ReactorElement;
+
+/// Classes of trace events that can be enabled or disabled individually
+enum class TraceEvent : std::uint32_t {
+  ReactionExecution = 1u << 0,  // reaction_execution_starts and _finishes
+  ScheduleAction = 1u << 1,
+  TriggerReaction = 1u << 2,
+  TagAdvance = 1u << 3,
+  Level = 1u << 4,              // level_starts and _finishes
+  PhysicalTimeSleep = 1u << 5,  // physical_time_sleep_starts and _finishes
+  WorkerPark = 1u << 6,         // worker_parks and _unparks
+  IngressDrain = 1u << 7,
+  All = ~0u
+};
+
+/**
+ * Runtime configuration of which events are recorded when tracing is enabled.
+ *
+ * Events can be selected by their type, by the reactor subtree of the element
+ * they belong to, and by a glob pattern that is matched against the fully
+ * qualified name of the element. Of the selected events, only every n-th
+ * event can be recorded, and recording can be restricted to a window at the
+ * beginning of each period of physical time.
+ *
+ * Decisions that depend on the element are computed once per element and
+ * configuration and are cached in the element. Thus, checking the filter only
+ * costs a few relaxed atomic loads and a thread local counter increment in
+ * the common case. If the library is built without tracing support, checks
+ * via `trace_accepts()` compile to nothing.
+ */
+class TraceFilter {
+ private:
+  struct Selection {
+    std::vector<std::string> subtrees{};
+    std::string pattern{};
+  };
+
+  std::mutex mutex{};
+  std::shared_ptr<const Selection> selection{std::make_shared<Selection>()};
+
+  // Incremented whenever the selection changes. Generation 0 is reserved for
+  // caches that were never written.
+  std::atomic<std::uint32_t> generation{1};
+  std::atomic<std::uint32_t> event_mask{
+      static_cast<std::uint32_t>(TraceEvent::All)};
+  std::atomic<std::uint32_t> sampling_rate{1};
+  std::atomic<Duration::rep> window_period{0};
+  std::atomic<Duration::rep> window_length{0};
+
+  bool selects(const ReactorElement* element) const;
+  bool in_sample() const;
+
+  static bool match(const char* pattern, const char* name);
+
+  void update_selection(const std::function<void(Selection&)>& update);
+
+ public:
+  /// Enable exactly the given event types (bitwise or of TraceEvent values)
+  void set_events(std::uint32_t mask) {
+    event_mask.store(mask, std::memory_order_relaxed);
+  }
+  void enable(TraceEvent event) {
+    event_mask.fetch_or(static_cast<std::uint32_t>(event),
+                        std::memory_order_relaxed);
+  }
+  void disable(TraceEvent event) {
+    event_mask.fetch_and(~static_cast<std::uint32_t>(event),
+                         std::memory_order_relaxed);
+  }
+
+  /**
+   * Only record events of elements that belong to the reactor with the given
+   * fully qualified name or to one of its contained reactors. Multiple
+   * subtrees can be added. If no subtree is given, elements of all reactors
+   * are recorded.
+   */
+  void add_subtree(const std::string& fqn);
+  /**
+   * Only record events of elements whose fully qualified name matches the
+   * given pattern. `*` matches any sequence of characters and `?` matches a
+   * single character. An empty pattern matches all elements.
+   */
+  void set_pattern(const std::string& pattern);
+  /// Record events of all elements again
+  void clear_selection();
+
+  /// Only record every n-th selected event of each thread
+  void set_sampling_rate(std::uint32_t n);
+  /**
+   * Only record events in the first `length` of every `period` of physical
+   * time. A period of zero disables windowing.
+   */
+  void set_time_window(Duration period, Duration length);
+
+  /**
+   * Check if an event of the given type and belonging to the given element
+   * should be recorded.
+   */
+  bool accepts(TraceEvent event, const ReactorElement* element) const {
+    if constexpr (tracing_enabled) {
+      if ((event_mask.load(std::memory_order_relaxed) &
+           static_cast<std::uint32_t>(event)) == 0) {
+        return false;
+      }
+      return selects(element) && in_sample();
+    } else {
+      return false;
+    }
+  }
+
+  /**
+   * Check if a scheduler event of the given type should be recorded. These
+   * events do not belong to any element and are only filtered by type.
+   */
+  bool accepts(TraceEvent event) const {
+    if constexpr (tracing_enabled) {
+      return (event_mask.load(std::memory_order_relaxed) &
+              static_cast<std::uint32_t>(event)) != 0;
+    } else {
+      return false;
+    }
+  }
+
+  /// The filter applied to all trace events of this process
+  static TraceFilter& instance();
+};
+
+inline TraceFilter& trace_filter() { return TraceFilter::instance(); }
+
+/**
+ * Check if an event of the given type and belonging to the given element
+ * passes the filter. Without tracing support, this is constant false and does
+ * not access the filter at all.
+ */
+inline bool trace_accepts(TraceEvent event, const ReactorElement* element) {
+  if constexpr (tracing_enabled) {
+    return trace_filter().accepts(event, element);
+  } else {
+    return false;
+  }
+}
+
+/// Check if a scheduler event of the given type passes the filter
+inline bool trace_accepts(TraceEvent event) {
+  if constexpr (tracing_enabled) {
+    return trace_filter().accepts(event);
+  } else {
+    return false;
+  }
+}
+
+}  // namespace reactor
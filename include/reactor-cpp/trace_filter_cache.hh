@@ -0,0 +1,36 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+
+namespace reactor {
+
+/**
+ * Caches the filter decision for a single reactor element.
+ *
+ * The cache is tagged with the generation of the filter configuration it was
+ * computed for, and thus is invalidated implicitly whenever the filter is
+ * reconfigured.
+ */
+class TraceFilterCache {
+ private:
+  // generation << 1 | accepted
+  mutable std::atomic<std::uint32_t> value{0};
+
+ public:
+  TraceFilterCache() = default;
+  TraceFilterCache(const TraceFilterCache&) {}
+  TraceFilterCache(TraceFilterCache&&) {}
+
+  friend class TraceFilter;
+};
+
+}  // namespace reactor
@@ -18,9 +18,11 @@
 
 namespace reactor {
 
-// forward declaration
+// forward declarations
 template <class T>
 class ImmutableValuePtr;
+template <class T>
+class ArenaValuePtr;
 
 /**
  * @brief Smart pointer to a mutable value.
@@ -234,6 +236,21 @@ class ImmutableValuePtr {
    */
   explicit ImmutableValuePtr(MutableValuePtr<T>&& ptr)
       : internal_ptr(std::move(ptr.internal_ptr)) {}
+  /**
+   * @rst
+   * Move constructor from :class:`ArenaValuePtr`.
+   *
+   * Constructs an :class:`ImmutableValuePtr` by transferring ownership of a
+   * value that lives in a :class:`SharedMemoryArena`. ``ptr`` looses
+   * ownership and will own nothing. The value is returned to the arena when
+   * it is not owned by any instance of :class:`ImmutableValuePtr` anymore.
+   * @endrst
+   */
+  explicit ImmutableValuePtr(ArenaValuePtr<T>&& ptr)
+      : internal_ptr(ptr.value,
+                     typename ArenaValuePtr<T>::Deleter{ptr.arena}) {
+    ptr.value = nullptr;
+  }
 
   /**
    * Assignment operator from ``nullptr``.
@@ -323,8 +340,9 @@ class ImmutableValuePtr {
    * the copy to a newly created :class:`MutableValuePtr`.
    * @endrst
    *
-   * Requires that ``T`` is copy constructable. The behavior is undefined if
-   * ``get() == nullptr``.
+   * Requires that ``T`` is copy constructable. The copy is always allocated on
+   * the heap, even if the original value lives in a shared memory arena. The
+   * behavior is undefined if ``get() == nullptr``.
    * @return a mutable value pointer
    */
   MutableValuePtr<T> get_mutable_copy() const {
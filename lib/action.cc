@@ -10,6 +10,7 @@
 
 #include "reactor-cpp/assert.hh"
 #include "reactor-cpp/environment.hh"
+#include "reactor-cpp/mode.hh"
 #include "reactor-cpp/reaction.hh"
 
 #include <assert.h>
@@ -19,12 +20,13 @@ namespace reactor {
 void BaseAction::register_trigger(Reaction* reaction) {
   assert(reaction != nullptr);
   assert(this->environment() == reaction->environment());
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
            "Triggers may only be registered during assembly phase!");
   reactor::validate(this->container() == reaction->container(),
            "Action triggers must belong to the same reactor as the triggered "
            "reaction");
-  assert(_triggers.insert(reaction).second);
+  [[maybe_unused]] bool result = _triggers.insert(reaction).second;
+  assert(result);
 }
 
 void BaseAction::register_scheduler(Reaction* reaction) {
@@ -32,18 +34,27 @@ void BaseAction::register_scheduler(Reaction* reaction) {
   assert(this->environment() == reaction->environment());
   reactor::validate(is_logical(), "only logical action can be scheduled by a reaction!");
   reactor::validate(
-      this->environment()->phase() == Environment::Phase::Assembly,
+      this->environment()->allows_assembly(),
       "Schedulers for actions may only be registered during assembly phase!");
   // the reaction must belong to the same reactor as this action
   reactor::validate(this->container() == reaction->container(),
            "Scheduable actions must belong to the same reactor as the "
            "triggered reaction");
   //auto r = _schedulers.insert(reaction);
-  assert(_schedulers.insert(reaction).second);
+  [[maybe_unused]] bool result = _schedulers.insert(reaction).second;
+  assert(result);
 }
 
-void Timer::startup() {
-  Tag t0 = Tag::from_physical_time(environment()->start_time());
+void BaseAction::update_active_triggers() {
+  _active_triggers.clear();
+  for (auto r : _triggers) {
+    if (r->is_active()) {
+      _active_triggers.push_back(r);
+    }
+  }
+}
+
+void Timer::schedule_first(const Tag& t0) {
   if (_offset != Duration::zero()) {
     environment()->scheduler()->schedule_sync(t0.delay(_offset), this, nullptr);
   } else {
@@ -51,6 +62,27 @@ void Timer::startup() {
   }
 }
 
+void Timer::startup() {
+  if (!is_active()) {
+    return;
+  }
+  // Timers of reactors that are added by a mutation start relative to the
+  // current tag instead of the start time.
+  if (environment()->phase() == Environment::Phase::Mutation) {
+    restart();
+  } else {
+    schedule_first(Tag::from_physical_time(environment()->start_time()));
+  }
+}
+
+void Timer::restart() {
+  schedule_first(Tag::from_logical_time(environment()->logical_time()).delay());
+}
+
+bool Timer::is_active() const {
+  return _mode == nullptr || _mode->is_active();
+}
+
 void Timer::cleanup() {
   // schedule the timer again
   if (_period != Duration::zero()) {
@@ -10,23 +10,42 @@
 
 #include <algorithm>
 #include <fstream>
+#include <iomanip>
 #include <map>
+#include <sstream>
 #include <cassert>
 
+#include "reactor-cpp/action.hh"
 #include "reactor-cpp/assert.hh"
 #include "reactor-cpp/logging.hh"
+#include "reactor-cpp/mode.hh"
 #include "reactor-cpp/port.hh"
 #include "reactor-cpp/reaction.hh"
 
 namespace reactor {
 
+Environment::Environment(Environment* parent,
+                         unsigned num_workers,
+                         bool fast_fwd_execution)
+    : Environment(num_workers, true, fast_fwd_execution) {
+  assert(parent != nullptr);
+  reactor::validate(parent->phase() == Phase::Construction,
+           "Enclaves may only be created during construction phase!");
+  parent->_enclaves.push_back(this);
+}
+
 void Environment::register_reactor(Reactor* reactor) {
   assert(reactor != nullptr);
-  reactor::validate(this->phase() == Phase::Construction,
-           "Reactors may only be registered during construction phase!");
+  reactor::validate(this->allows_construction(),
+           "Reactors may only be registered during construction or mutation "
+           "phase!");
   reactor::validate(reactor->is_top_level(),
            "The environment may only contain top level reactors!");
-  assert(_top_level_reactors.insert(reactor).second);
+  [[maybe_unused]] bool result = _top_level_reactors.insert(reactor).second;
+  assert(result);
+  if (_phase == Phase::Mutation) {
+    added_reactors.insert(reactor);
+  }
 }
 
 void recursive_assemble(Reactor* container) {
@@ -43,6 +62,39 @@ void Environment::assemble() {
   for (auto r : _top_level_reactors) {
     recursive_assemble(r);
   }
+  for (auto e : _enclaves) {
+    e->assemble();
+  }
+}
+
+void Environment::add_dependency(Reaction* reaction, Reaction* dependency) {
+  dependencies[reaction].insert(dependency);
+  dependents[dependency].insert(reaction);
+}
+
+void Environment::remove_dependencies(Reaction* reaction) {
+  auto it = dependencies.find(reaction);
+  if (it != dependencies.end()) {
+    for (auto d : it->second) {
+      dependents[d].erase(reaction);
+    }
+    it->second.clear();
+  }
+}
+
+void Environment::add_port_dependencies(Reaction* reaction) {
+  // connect all reactions this reaction depends on
+  for (auto d : reaction->dependencies()) {
+    auto source = d;
+    while (source->has_inward_binding()) {
+      source = source->inward_binding();
+    }
+    for (auto ad : source->antidependencies()) {
+      if (!ad->is_pruned()) {
+        add_dependency(reaction, ad);
+      }
+    }
+  }
 }
 
 void Environment::build_dependency_graph(Reactor* reactor) {
@@ -53,51 +105,229 @@ void Environment::build_dependency_graph(Reactor* reactor) {
   // get reactions from this reactor; also order reactions by their priority
   std::map<int, Reaction*> priority_map;
   for (auto r : reactor->reactions()) {
-    reactions.insert(r);
     auto result = priority_map.emplace(r->priority(), r);
     reactor::validate(result.second,
              "priorities must be unique for all reactions of the same reactor");
+    if (!r->is_pruned()) {
+      reactions.insert(r);
+      dependencies[r];
+      dependents[r];
+    }
   }
 
-  // connect all reactions this reaction depends on
   for (auto r : reactor->reactions()) {
-    for (auto d : r->dependencies()) {
+    if (!r->is_pruned()) {
+      add_port_dependencies(r);
+      add_priority_dependencies(r);
+    }
+  }
+}
+
+void Environment::add_priority_dependencies(Reaction* reaction) {
+  // Connect the reaction to the reactions of the same reactor with the next
+  // lower priority that it conflicts with. Reactions of different modes or
+  // of different state partitions do not conflict. Thus, each mode and each
+  // partition forms its own chain and only reactions that do not belong to
+  // any mode or partition, or that change modes, are ordered with respect to
+  // all others.
+  std::map<int, Reaction*, std::greater<int>> lower_priority;
+  for (auto r : reaction->container()->reactions()) {
+    if (r->priority() < reaction->priority() && !r->is_pruned()) {
+      lower_priority.emplace(r->priority(), r);
+    }
+  }
+
+  // A conflicting reaction does not need to be connected if it conflicts
+  // with an already connected reaction, as that one transitively depends on
+  // it.
+  std::vector<Reaction*> connected;
+  for (auto& kv : lower_priority) {
+    auto r = kv.second;
+    if (!reaction->conflicts_with(r)) {
+      continue;
+    }
+    if (std::none_of(connected.begin(), connected.end(),
+                     [r](Reaction* c) { return c->conflicts_with(r); })) {
+      add_dependency(reaction, r);
+      connected.push_back(r);
+    }
+    // all remaining reactions conflict with this one
+    if (r->mode() == nullptr && (!r->is_partitioned() || r->changes_mode())) {
+      break;
+    }
+  }
+}
+
+void collect_elements(Reactor* container,
+                      std::set<BaseAction*>& actions,
+                      std::set<BasePort*>& ports,
+                      std::set<Reaction*>& reactions) {
+  actions.insert(container->actions().begin(), container->actions().end());
+  ports.insert(container->inputs().begin(), container->inputs().end());
+  ports.insert(container->outputs().begin(), container->outputs().end());
+  reactions.insert(container->reactions().begin(),
+                   container->reactions().end());
+  for (auto r : container->reactors()) {
+    collect_elements(r, actions, ports, reactions);
+  }
+}
+
+void collect_readers(BasePort* port, std::set<Reaction*>& readers) {
+  readers.insert(port->dependencies().begin(), port->dependencies().end());
+  for (auto binding : port->outward_bindings()) {
+    collect_readers(binding, readers);
+  }
+}
+
+std::set<Reaction*> Environment::find_observable_reactions() const {
+  std::set<BaseAction*> actions;
+  std::set<BasePort*> ports;
+  std::set<Reaction*> all;
+  for (auto r : _top_level_reactors) {
+    collect_elements(r, actions, ports, all);
+  }
+
+  // The effects of all reactions that are not pure are observable. Starting
+  // from those, mark all reactions that write a port or schedule an action
+  // that an observable reaction reads or is triggered by.
+  std::map<BaseAction*, std::vector<Reaction*>> schedulers;
+  std::set<Reaction*> observable;
+  std::vector<Reaction*> worklist;
+  for (auto r : all) {
+    for (auto a : r->scheduable_actions()) {
+      schedulers[a].push_back(r);
+    }
+    if (!r->is_pure()) {
+      observable.insert(r);
+      worklist.push_back(r);
+    }
+  }
+  auto mark = [&observable, &worklist](Reaction* r) {
+    if (observable.insert(r).second) {
+      worklist.push_back(r);
+    }
+  };
+  while (!worklist.empty()) {
+    auto reaction = worklist.back();
+    worklist.pop_back();
+    for (auto d : reaction->dependencies()) {
       auto source = d;
       while (source->has_inward_binding()) {
         source = source->inward_binding();
       }
       for (auto ad : source->antidependencies()) {
-        dependencies.push_back(std::make_pair(r, ad));
+        mark(ad);
       }
     }
+    for (auto a : reaction->action_triggers()) {
+      for (auto s : schedulers[a]) {
+        mark(s);
+      }
+    }
+  }
+
+  return observable;
+}
+
+void Environment::prune_reactions() {
+  std::set<BaseAction*> actions;
+  std::set<BasePort*> ports;
+  std::set<Reaction*> all;
+  for (auto r : _top_level_reactors) {
+    collect_elements(r, actions, ports, all);
   }
 
-  // connect reactions by priority
-  if (priority_map.size() > 1) {
-    auto it = priority_map.begin();
-    auto next = std::next(it);
-    while (next != priority_map.end()) {
-      dependencies.push_back(std::make_pair(next->second, it->second));
-      it++;
-      next = std::next(it);
+  auto observable = find_observable_reactions();
+  for (auto r : all) {
+    if (observable.count(r) == 0) {
+      log::Debug() << "Prune reaction " << r->fqn()
+                   << " as its effects are not observable";
+      r->_pruned = true;
+      pruned_reactions.insert(r);
     }
   }
 }
 
+std::set<Reaction*> Environment::revive_reactions() {
+  std::set<Reaction*> revived;
+  if (pruned_reactions.empty()) {
+    return revived;
+  }
+
+  // The set of observable reactions is closed under the walk in
+  // find_observable_reactions(). A mutation can only extend it by binding a
+  // port that an observable reaction reads or by adding new reactions. Thus,
+  // it suffices to walk from those reactions and to follow only the edges
+  // that lead to pruned reactions.
+  std::vector<Reaction*> worklist;
+  std::set<Reaction*> readers;
+  for (auto p : changed_ports) {
+    collect_readers(p, readers);
+  }
+  for (auto r : readers) {
+    if (!r->is_pruned()) {
+      worklist.push_back(r);
+    }
+  }
+  for (auto r : added_reactors) {
+    std::set<BaseAction*> actions;
+    std::set<BasePort*> ports;
+    std::set<Reaction*> added;
+    collect_elements(r, actions, ports, added);
+    worklist.insert(worklist.end(), added.begin(), added.end());
+  }
+
+  auto revive = [this, &revived, &worklist](Reaction* r) {
+    if (pruned_reactions.erase(r) == 1) {
+      log::Debug() << "Restore reaction " << r->fqn()
+                   << " as its effects became observable";
+      r->_pruned = false;
+      revived.insert(r);
+      worklist.push_back(r);
+    }
+  };
+  while (!worklist.empty()) {
+    auto reaction = worklist.back();
+    worklist.pop_back();
+    for (auto d : reaction->dependencies()) {
+      auto source = d;
+      while (source->has_inward_binding()) {
+        source = source->inward_binding();
+      }
+      for (auto ad : source->antidependencies()) {
+        revive(ad);
+      }
+    }
+    for (auto a : reaction->action_triggers()) {
+      for (auto s : a->schedulers()) {
+        revive(s);
+      }
+    }
+  }
+  return revived;
+}
+
 std::thread Environment::startup() {
   reactor::validate(this->phase() == Phase::Assembly,
            "startup() may only be called during assembly phase!");
 
   // build the dependency graph
+  prune_reactions();
   for (auto r : _top_level_reactors) {
     build_dependency_graph(r);
   }
   calculate_indexes();
 
+  // start the enclaves first, so that they are ready to receive values
+  for (auto e : _enclaves) {
+    _enclave_threads.emplace_back(e->startup());
+  }
+
   log::Info() << "Starting the execution";
   _phase = Phase::Startup;
 
   _start_time = get_physical_time();
+  _profiling_start = _start_time;
   // startupialize all reactors
   for (auto r : _top_level_reactors) {
     r->startup();
@@ -105,7 +335,12 @@ std::thread Environment::startup() {
 
   // start processing events
   _phase = Phase::Execution;
-  return std::thread([this]() { this->_scheduler.start(); });
+  return std::thread([this]() {
+    this->_scheduler.start();
+    for (auto& t : this->_enclave_threads) {
+      t.join();
+    }
+  });
 }
 
 void Environment::sync_shutdown() {
@@ -122,11 +357,21 @@ void Environment::sync_shutdown() {
   _phase = Phase::Deconstruction;
 
   _scheduler.stop();
+
+  for (auto e : _enclaves) {
+    e->async_shutdown();
+  }
 }
 
 void Environment::async_shutdown() {
   _scheduler.lock();
-  sync_shutdown();
+  if (_phase == Phase::Mutation) {
+    // The mutation is applied without holding the lock. Shut down once it
+    // completed, as no new reactions may be triggered in the meantime.
+    _shutdown_pending = true;
+  } else if (_phase != Phase::Deconstruction) {
+    sync_shutdown();
+  }
   _scheduler.unlock();
 }
 
@@ -136,10 +381,112 @@ std::string dot_name(ReactorElement* r) {
   return fqn;
 }
 
-void Environment::export_dependency_graph(const std::string& path) {
+void Environment::set_executor(Executor* executor) {
+  reactor::validate(
+      _phase == Phase::Construction || _phase == Phase::Assembly,
+      "An executor may only be set before the execution starts!");
+  _scheduler.set_executor(executor);
+}
+
+void Environment::set_scheduling_policy(
+    std::unique_ptr<SchedulingPolicy> policy) {
+  reactor::validate(
+      _phase == Phase::Construction,
+      "A scheduling policy may only be set during the construction phase!");
+  reactor::validate(policy != nullptr, "The scheduling policy may not be null!");
+  _scheduler.set_policy(std::move(policy));
+}
+
+void Environment::enable_profiling() {
+  if (!_profiling.exchange(true)) {
+    _profiling_start = get_physical_time();
+  }
+}
+
+void Environment::profile_execution(Reaction* reaction,
+                                    TimePoint start,
+                                    TimePoint finish) {
+  auto& profile = reaction->_profile;
+  const auto& time = logical_time();
+  profile._execution_time.add(finish - start);
+  profile.tag_time_point = time.time_point();
+  profile.tag_micro_step = time.micro_step();
+  profile.finish = finish;
+
+  // All dependencies have a lower index and thus finished before this
+  // reaction started. Find the one that finished last in the current tag.
+  profile.critical_predecessor = nullptr;
+  auto it = dependencies.find(reaction);
+  if (it == dependencies.end()) {
+    return;
+  }
+  TimePoint latest{};
+  for (auto d : it->second) {
+    const auto& p = d->_profile;
+    if (p.tag_time_point == time.time_point() &&
+        p.tag_micro_step == time.micro_step() &&
+        (profile.critical_predecessor == nullptr || p.finish > latest)) {
+      profile.critical_predecessor = d;
+      latest = p.finish;
+    }
+  }
+}
+
+void Environment::profile_critical_path(Reaction* last) {
+  _profiled_tags++;
+  for (auto r = last; r != nullptr; r = r->_profile.critical_predecessor) {
+    r->_profile._critical++;
+    if (r->_profile.critical_predecessor != nullptr) {
+      r->_profile._critical_dependencies[r->_profile.critical_predecessor]++;
+    }
+  }
+}
+
+namespace {
+
+// A color in the HSV format used by dot that fades from a shade of gray
+// with the given brightness (heat 0.0) to red (heat 1.0).
+std::string heat_color(double heat, double brightness) {
+  std::ostringstream color;
+  color << std::fixed << std::setprecision(3) << "0.000 " << heat << ' '
+        << brightness + (1.0 - brightness) * heat;
+  return color.str();
+}
+
+std::string format_us(Duration duration) {
+  std::ostringstream str;
+  str << std::fixed << std::setprecision(1)
+      << static_cast<double>(duration.count()) / 1000.0 << "us";
+  return str.str();
+}
+
+}  // namespace
+
+void Environment::export_dependency_graph(const std::string& path,
+                                          bool with_profile) {
   std::ofstream dot;
   dot.open(path);
 
+  // The heat of a reaction is its total execution time and the heat of a
+  // dependency is the number of tags in which it was critical, both relative
+  // to the maximum.
+  Duration max_total{Duration::zero()};
+  std::uint64_t max_critical{0};
+  double seconds{0.0};
+  if (with_profile) {
+    for (auto r : reactions) {
+      max_total = std::max(max_total, r->profile().execution_time().total());
+    }
+    for (auto& kv : dependencies) {
+      for (auto d : kv.second) {
+        max_critical = std::max(max_critical, kv.first->profile().critical(d));
+      }
+    }
+    seconds = std::chrono::duration<double>(get_physical_time() -
+                                            _profiling_start)
+                  .count();
+  }
+
   // sort all reactions by their index
   std::map<unsigned, std::vector<Reaction*>> reactions_by_index;
   for (auto r : reactions) {
@@ -155,7 +502,23 @@ void Environment::export_dependency_graph(const std::string& path) {
     dot << "subgraph {\n";
     dot << "rank=same;\n";
     for (auto r : index_reactions.second) {
-      dot << dot_name(r) << " [label=\"" << r->fqn() << "\"];" << std::endl;
+      if (!with_profile) {
+        dot << dot_name(r) << " [label=\"" << r->fqn() << "\"];" << std::endl;
+        continue;
+      }
+      const auto& time = r->profile().execution_time();
+      double heat =
+          max_total == Duration::zero()
+              ? 0.0
+              : static_cast<double>(time.total().count()) /
+                    static_cast<double>(max_total.count());
+      dot << dot_name(r) << " [label=\"" << r->fqn() << "\\nmean "
+          << format_us(time.mean()) << ", p99 "
+          << format_us(time.percentile(99)) << "\\n" << std::fixed
+          << std::setprecision(1)
+          << (seconds > 0 ? static_cast<double>(time.count()) / seconds : 0.0)
+          << " Hz\", style=filled, fillcolor=\"" << heat_color(heat, 1.0)
+          << "\"];" << std::endl;
     }
     dot << "}\n";
   }
@@ -172,8 +535,21 @@ void Environment::export_dependency_graph(const std::string& path) {
   }
 
   // add all the dependencies
-  for (auto d : dependencies) {
-    dot << dot_name(d.first) << " -> " << dot_name(d.second) << '\n';
+  for (auto& kv : dependencies) {
+    for (auto d : kv.second) {
+      dot << dot_name(kv.first) << " -> " << dot_name(d);
+      if (with_profile) {
+        auto critical = kv.first->profile().critical(d);
+        double heat = max_critical == 0
+                          ? 0.0
+                          : static_cast<double>(critical) /
+                                static_cast<double>(max_critical);
+        dot << " [label=\"" << critical << "\", color=\""
+            << heat_color(heat, 0.5) << "\", penwidth=" << std::fixed
+            << std::setprecision(1) << 1 + 4 * heat << ']';
+      }
+      dot << '\n';
+    }
   }
   dot << "}\n";
 
@@ -184,13 +560,7 @@ void Environment::export_dependency_graph(const std::string& path) {
 
 void Environment::calculate_indexes() {
   // build the graph
-  std::map<Reaction*, std::set<Reaction*>> graph;
-  for (auto r : reactions) {
-    graph[r];
-  }
-  for (auto d : dependencies) {
-    graph[d.first].insert(d.second);
-  }
+  std::map<Reaction*, std::set<Reaction*>> graph{dependencies};
 
   log::Debug() << "Reactions sorted by index:";
   unsigned index = 0;
@@ -233,4 +603,239 @@ void Environment::calculate_indexes() {
   _max_reaction_index = index - 1;
 }
 
+void Environment::request_mutation(std::function<void(void)> mutation) {
+  reactor::validate(mutation != nullptr, "Mutations may not be nullptr!");
+  {
+    std::lock_guard<std::mutex> lg(m_mutations);
+    mutations.emplace_back(std::move(mutation));
+    _mutations_pending.store(true, std::memory_order_release);
+  }
+  // wake up the scheduler in case it waits for new events
+  _scheduler.notify();
+}
+
+void Environment::remove_reactor(Reactor* reactor) {
+  assert(reactor != nullptr);
+  reactor::validate(this->phase() == Phase::Mutation,
+           "Reactors may only be removed during mutation phase!");
+  reactor::validate(reactor->is_top_level() &&
+                        _top_level_reactors.count(reactor) == 1,
+           "Only top level reactors of this environment may be removed!");
+
+  std::set<BaseAction*> removed_actions;
+  std::set<BasePort*> removed_ports;
+  std::set<Reaction*> removed_reactions;
+  collect_elements(reactor, removed_actions, removed_ports, removed_reactions);
+
+  // disconnect all ports of the removed reactor
+  for (auto p : removed_ports) {
+    if (p->has_inward_binding()) {
+      p->inward_binding()->base_unbind_from(p);
+    }
+    std::vector<BasePort*> outward_bindings{p->outward_bindings()};
+    for (auto o : outward_bindings) {
+      p->base_unbind_from(o);
+    }
+  }
+  for (auto p : removed_ports) {
+    changed_ports.erase(p);
+  }
+
+  // remove all reactions from the dependency graph
+  for (auto r : removed_reactions) {
+    remove_dependencies(r);
+    for (auto d : dependents[r]) {
+      dependencies[d].erase(r);
+    }
+    dependencies.erase(r);
+    dependents.erase(r);
+    reactions.erase(r);
+    pruned_reactions.erase(r);
+  }
+
+  // make sure that no events remain for the removed actions
+  _scheduler.remove_events(removed_actions);
+
+  _top_level_reactors.erase(reactor);
+  added_reactors.erase(reactor);
+  log::Debug() << "Removed reactor " << reactor->fqn();
+}
+
+void Environment::mark_port_changed(BasePort* port) {
+  if (_phase == Phase::Mutation) {
+    changed_ports.insert(port);
+  }
+}
+
+bool reaches_loop(Reaction* reaction,
+                  const std::map<Reaction*, std::set<Reaction*>>& dependencies,
+                  std::map<Reaction*, bool>& on_path) {
+  auto result = on_path.emplace(reaction, true);
+  if (!result.second) {
+    // either the reaction is on the current path or it was already visited
+    return result.first->second;
+  }
+  for (auto d : dependencies.at(reaction)) {
+    if (reaches_loop(d, dependencies, on_path)) {
+      return true;
+    }
+  }
+  result.first->second = false;
+  return false;
+}
+
+bool Environment::update_indexes(const std::set<Reaction*>& affected) {
+  // Any loop introduced by a mutation contains one of the affected reactions,
+  // as only their dependencies changed. Check for loops before any index is
+  // updated.
+  std::map<Reaction*, bool> on_path;
+  for (auto r : affected) {
+    if (reaches_loop(r, dependencies, on_path)) {
+      return false;
+    }
+  }
+
+  // Only reactions whose dependencies changed and, transitively, reactions
+  // that depend on a reaction whose index increased need to be visited.
+  // Indexes that decrease remain valid for all dependent reactions.
+  std::vector<Reaction*> worklist{affected.begin(), affected.end()};
+  while (!worklist.empty()) {
+    auto reaction = worklist.back();
+    worklist.pop_back();
+
+    unsigned index = 0;
+    for (auto d : dependencies[reaction]) {
+      index = std::max(index, d->index() + 1);
+    }
+
+    bool increased = index > reaction->index();
+    reaction->set_index(index);
+    if (increased) {
+      _max_reaction_index = std::max(_max_reaction_index, index);
+      for (auto d : dependents[reaction]) {
+        worklist.push_back(d);
+      }
+    }
+  }
+  return true;
+}
+
+bool Environment::apply_mutations(std::unique_lock<std::mutex>& lock) {
+  std::vector<std::function<void(void)>> pending;
+  {
+    std::lock_guard<std::mutex> lg(m_mutations);
+    pending.swap(mutations);
+    _mutations_pending.store(false, std::memory_order_release);
+  }
+
+  log::Debug() << "Apply " << pending.size() << " topology mutation(s)";
+  // The phase is only changed while holding the lock, so that a concurrent
+  // shutdown can be deferred until the mutation is completed (see
+  // async_shutdown()). The mutations themselves may schedule events or
+  // request further mutations and thus are applied without holding the lock.
+  _phase = Phase::Mutation;
+  lock.unlock();
+  for (auto& mutation : pending) {
+    mutation();
+  }
+
+  // assemble all newly created reactors and add them to the dependency graph
+  std::set<Reaction*> affected;
+  for (auto r : added_reactors) {
+    recursive_assemble(r);
+  }
+  // Restore pruned reactions that became observable before any dependencies
+  // are computed, so that they are considered by all new reactions.
+  auto revived = revive_reactions();
+  for (auto r : added_reactors) {
+    build_dependency_graph(r);
+    std::set<BaseAction*> actions;
+    std::set<BasePort*> ports;
+    collect_elements(r, actions, ports, affected);
+  }
+  for (auto r : revived) {
+    reactions.insert(r);
+    dependencies[r];
+    dependents[r];
+    add_port_dependencies(r);
+    add_priority_dependencies(r);
+    r->container()->update_active_triggers();
+    affected.insert(r);
+  }
+  for (auto r : affected) {
+    r->set_index(0);
+  }
+
+  // recompute the dependencies of all reactions that read from a port whose
+  // binding changed or that is written by a restored reaction, and of all
+  // reactions that follow a restored reaction in the priority order
+  std::set<Reaction*> readers;
+  for (auto p : changed_ports) {
+    collect_readers(p, readers);
+  }
+  for (auto r : revived) {
+    for (auto p : r->antidependencies()) {
+      collect_readers(p, readers);
+    }
+    for (auto s : r->container()->reactions()) {
+      if (s->priority() > r->priority()) {
+        readers.insert(s);
+      }
+    }
+  }
+  for (auto r : readers) {
+    if (reactions.count(r) == 1 && affected.count(r) == 0) {
+      remove_dependencies(r);
+      add_port_dependencies(r);
+      add_priority_dependencies(r);
+      affected.insert(r);
+    }
+  }
+
+  bool valid = update_indexes(affected);
+  if (valid) {
+    // start all newly created reactors
+    for (auto r : added_reactors) {
+      r->startup();
+    }
+
+    log::Debug() << "Mutation added " << added_reactors.size()
+                 << " reactor(s) and changed " << changed_ports.size()
+                 << " binding(s); " << affected.size()
+                 << " reaction(s) were reindexed";
+  } else {
+    export_dependency_graph("/tmp/reactor_dependency_graph.dot");
+    log::Error() << "A mutation introduced a loop in the dependency graph. "
+                    "Graph was written to /tmp/reactor_dependency_graph.dot. "
+                    "Stopping the execution.";
+  }
+  added_reactors.clear();
+  changed_ports.clear();
+
+  lock.lock();
+  if (!valid) {
+    // No reactions may execute on the invalid graph, including the shutdown
+    // reactions. The scheduler stops without processing any further tags.
+    _phase = Phase::Deconstruction;
+    for (auto e : _enclaves) {
+      e->async_shutdown();
+    }
+    return false;
+  }
+
+  _phase = Phase::Execution;
+  if (_shutdown_pending) {
+    _shutdown_pending = false;
+    sync_shutdown();
+  }
+  return true;
+}
+
+bool Environment::is_added_by_mutation(Reactor* reactor) const {
+  while (!reactor->is_top_level()) {
+    reactor = reactor->container();
+  }
+  return added_reactors.count(reactor) == 1;
+}
+
 }  // namespace reactor
@@ -0,0 +1,354 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include "reactor-cpp/flight_recorder.hh"
+
+#include "reactor-cpp/assert.hh"
+#include "reactor-cpp/logging.hh"
+#include "reactor-cpp/reaction.hh"
+#include "reactor-cpp/reactor.hh"
+#include "reactor-cpp/scheduler.hh"
+
+#include <fstream>
+#include <iomanip>
+#include <map>
+
+namespace reactor {
+
+namespace {
+
+constexpr std::size_t default_capacity{1 << 16};
+constexpr Duration default_window{std::chrono::seconds(10)};
+
+std::string escape(const std::string& str) {
+  std::string result;
+  for (char c : str) {
+    if (c == '"' || c == '\\') {
+      result += '\\';
+    }
+    result += c;
+  }
+  return result;
+}
+
+// Print a timestamp given in nanoseconds in microseconds without loss of
+// precision
+struct Microseconds {
+  std::int64_t ns;
+};
+
+std::ostream& operator<<(std::ostream& os, Microseconds us) {
+  auto ns = us.ns;
+  if (ns < 0) {
+    os << '-';
+    ns = -ns;
+  }
+  return os << ns / 1000 << '.' << std::setw(3) << std::setfill('0')
+            << ns % 1000 << std::setfill(' ');
+}
+
+}  // namespace
+
+FlightRecorder::FlightRecorder() {
+  configure(default_capacity, default_window);
+}
+
+FlightRecorder::~FlightRecorder() {
+  {
+    std::lock_guard<std::mutex> lock(m_dump);
+    terminate_writer = true;
+  }
+  cv_dump.notify_one();
+  if (writer.joinable()) {
+    writer.join();
+  }
+}
+
+FlightRecorder& FlightRecorder::instance() {
+  static FlightRecorder recorder{};
+  return recorder;
+}
+
+void FlightRecorder::configure(std::size_t capacity, Duration window) {
+  reactor::validate(capacity > 0,
+                    "The flight recorder capacity must be positive");
+  std::size_t size = 1;
+  while (size < capacity) {
+    size <<= 1;
+  }
+  ring.reset(new Record[size]);
+  mask = size - 1;
+  position.store(0, std::memory_order_relaxed);
+  this->window.store(window.count(), std::memory_order_relaxed);
+}
+
+void FlightRecorder::set_file_prefix(const std::string& prefix) {
+  std::lock_guard<std::mutex> lock(m_dump);
+  file_prefix = prefix;
+}
+
+void FlightRecorder::record(FlightEvent type,
+                            const ReactorElement* element,
+                            TimePoint tag_time,
+                            std::uint64_t argument) {
+  auto index = position.fetch_add(1, std::memory_order_relaxed);
+  auto& record = ring[index & mask];
+
+  record.sequence.store(0, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  record.element.store(element, std::memory_order_relaxed);
+  record.time.store(get_physical_time().time_since_epoch().count(),
+                    std::memory_order_relaxed);
+  record.tag_time.store(tag_time.time_since_epoch().count(),
+                        std::memory_order_relaxed);
+  record.argument.store(argument, std::memory_order_relaxed);
+  record.type.store(type, std::memory_order_relaxed);
+  auto worker = Worker::current_worker;
+  record.worker.store(worker == nullptr ? -1 : static_cast<int>(worker->id),
+                      std::memory_order_relaxed);
+  record.sequence.store(index + 1, std::memory_order_release);
+}
+
+void FlightRecorder::deadline_missed(const Reaction* reaction, Duration lag) {
+  record(FlightEvent::DeadlineMiss, reaction,
+         reaction->container()->get_logical_time(), lag.count());
+  if (dump_on_deadline_miss.load(std::memory_order_relaxed)) {
+    trigger(get_physical_time());
+  }
+}
+
+void FlightRecorder::check_lag(const LogicalTime& logical_time) {
+  auto threshold = lag_threshold.load(std::memory_order_relaxed);
+  if (threshold > 0) {
+    auto now = get_physical_time();
+    auto lag = (now - logical_time.time_point()).count();
+    if (lag > threshold) {
+      record(FlightEvent::LagSpike, nullptr, logical_time.time_point(), lag);
+      trigger(now);
+    }
+  }
+}
+
+void FlightRecorder::trigger(TimePoint time) {
+  // rate limit automatic dumps to one per window
+  auto now = time.time_since_epoch().count();
+  auto last = last_automatic_dump.load(std::memory_order_relaxed);
+  if (last != 0 && now - last < window.load(std::memory_order_relaxed)) {
+    return;
+  }
+  if (!last_automatic_dump.compare_exchange_strong(last, now)) {
+    return;
+  }
+
+  // Only hand the dump off to the writer thread, which is started on the
+  // first dump. Copying the ring is left to the writer as well.
+  {
+    std::lock_guard<std::mutex> lock(m_dump);
+    dump_time = time;
+    dump_pending = true;
+    if (!writer.joinable()) {
+      writer = std::thread(&FlightRecorder::run_writer, this);
+    }
+  }
+  cv_dump.notify_one();
+}
+
+void FlightRecorder::run_writer() {
+  std::unique_lock<std::mutex> lock(m_dump);
+  while (true) {
+    cv_dump.wait(lock, [this]() { return dump_pending || terminate_writer; });
+    if (!dump_pending) {
+      return;
+    }
+    dump_pending = false;
+    auto time = dump_time;
+    auto path = file_prefix + "-" + std::to_string(dump_counter++) + ".json";
+
+    lock.unlock();
+    auto records = snapshot(time);
+    log::Info() << "Flight recorder dumps " << records.size()
+                << " events to " << path;
+    write(path, std::move(records));
+    lock.lock();
+  }
+}
+
+void FlightRecorder::dump(const std::string& path) {
+  write(path, snapshot(get_physical_time()));
+}
+
+std::vector<FlightRecorder::Snapshot> FlightRecorder::snapshot(
+    TimePoint until) {
+  std::vector<Snapshot> records;
+  auto end = position.load(std::memory_order_acquire);
+  auto begin = end > mask + 1 ? end - (mask + 1) : 0;
+  auto earliest = until.time_since_epoch().count() -
+                  window.load(std::memory_order_relaxed);
+  records.reserve(end - begin);
+
+  for (auto index = begin; index < end; index++) {
+    auto& record = ring[index & mask];
+    if (record.sequence.load(std::memory_order_acquire) != index + 1) {
+      // still being written or already overwritten
+      continue;
+    }
+    Snapshot snap{record.element.load(std::memory_order_relaxed),
+                  record.time.load(std::memory_order_relaxed),
+                  record.tag_time.load(std::memory_order_relaxed),
+                  record.argument.load(std::memory_order_relaxed),
+                  record.type.load(std::memory_order_relaxed),
+                  record.worker.load(std::memory_order_relaxed)};
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (record.sequence.load(std::memory_order_relaxed) == index + 1 &&
+        snap.time >= earliest) {
+      records.push_back(snap);
+    }
+  }
+
+  return records;
+}
+
+void FlightRecorder::write(const std::string& path,
+                           std::vector<Snapshot> records) {
+  std::ofstream out(path);
+  if (!out) {
+    log::Error() << "Flight recorder cannot open " << path;
+    return;
+  }
+  // Reactors are mapped to processes and their elements to threads, as in
+  // the traces produced by ctf_to_json.py.
+  struct Ids {
+    unsigned pid;
+    std::map<const ReactorElement*, unsigned> tids;
+  };
+  std::map<const Reactor*, Ids> ids;
+  auto get_ids = [&ids](const ReactorElement* element) {
+    auto pid = static_cast<unsigned>(ids.size() + 1);
+    auto& entry =
+        ids.try_emplace(element->container(), Ids{pid, {}}).first->second;
+    auto tid = static_cast<unsigned>(entry.tids.size());
+    tid = entry.tids.try_emplace(element, tid).first->second;
+    return std::make_pair(entry.pid, tid);
+  };
+
+  out << "{\"traceEvents\": [\n";
+  bool first = true;
+  auto separator = [&out, &first]() -> std::ostream& {
+    if (!first) {
+      out << ",\n";
+    }
+    first = false;
+    return out;
+  };
+
+  for (const auto& r : records) {
+    // timestamps are given in microseconds with nanosecond resolution
+    Microseconds ts{r.time};
+    Microseconds tag_ts{r.tag_time};
+    switch (r.type) {
+      case FlightEvent::ReactionExecutionStarts:
+      case FlightEvent::ReactionExecutionFinishes:
+        separator() << "{\"name\": \"" << escape(r.element->fqn())
+                    << "\", \"cat\": \"Execution\", \"ph\": \""
+                    << (r.type == FlightEvent::ReactionExecutionStarts ? 'B'
+                                                                        : 'E')
+                    << "\", \"ts\": " << ts << ", \"pid\": 0, \"tid\": "
+                    << r.worker << "}";
+        break;
+      case FlightEvent::ScheduleAction:
+      case FlightEvent::TriggerReaction: {
+        auto pid_tid = get_ids(r.element);
+        bool schedule = r.type == FlightEvent::ScheduleAction;
+        separator() << "{\"name\": \"" << (schedule ? "schedule" : "trigger")
+                    << "\", \"cat\": \"Reactors\", \"ph\": \"i\", \"ts\": "
+                    << tag_ts << ", \"pid\": " << pid_tid.first
+                    << ", \"tid\": " << pid_tid.second
+                    << ", \"s\": \"t\", \"cname\": \""
+                    << (schedule ? "terrible" : "light_memory_dump")
+                    << "\", \"args\": {\"timestamp_ns\": " << r.tag_time
+                    << ", \"microstep\": " << r.argument << "}}";
+        break;
+      }
+      case FlightEvent::DeadlineMiss:
+        separator() << "{\"name\": \"deadline miss "
+                    << escape(r.element->fqn())
+                    << "\", \"cat\": \"Execution\", \"ph\": \"i\", \"ts\": "
+                    << ts << ", \"pid\": 0, \"tid\": " << r.worker
+                    << ", \"s\": \"p\", \"cname\": \"terrible\", \"args\": "
+                    << "{\"lag_ns\": " << r.argument << "}}";
+        break;
+      case FlightEvent::TagAdvance:
+        separator() << "{\"name\": \"tag advance\", \"cat\": \"Scheduler\", "
+                    << "\"ph\": \"i\", \"ts\": " << ts
+                    << ", \"pid\": 0, \"tid\": " << r.worker
+                    << ", \"s\": \"p\", \"args\": {\"timestamp_ns\": "
+                    << r.tag_time << ", \"microstep\": " << r.argument
+                    << "}}";
+        break;
+      case FlightEvent::LevelStarts:
+      case FlightEvent::LevelFinishes:
+        separator() << "{\"name\": \"level " << (r.argument >> 32)
+                    << "\", \"cat\": \"Scheduler\", \"ph\": \""
+                    << (r.type == FlightEvent::LevelStarts ? 'B' : 'E')
+                    << "\", \"ts\": " << ts << ", \"pid\": 0, \"tid\": "
+                    << r.worker << ", \"args\": {\"width\": "
+                    << (r.argument & 0xffffffff) << "}}";
+        break;
+      case FlightEvent::PhysicalTimeSleepStarts:
+      case FlightEvent::PhysicalTimeSleepFinishes:
+        separator() << "{\"name\": \"sleep\", \"cat\": \"Scheduler\", "
+                    << "\"ph\": \""
+                    << (r.type == FlightEvent::PhysicalTimeSleepStarts ? 'B'
+                                                                        : 'E')
+                    << "\", \"ts\": " << ts << ", \"pid\": 0, \"tid\": "
+                    << r.worker << "}";
+        break;
+      case FlightEvent::WorkerParks:
+      case FlightEvent::WorkerUnparks:
+        separator() << "{\"name\": \"parked\", \"cat\": \"Scheduler\", "
+                    << "\"ph\": \""
+                    << (r.type == FlightEvent::WorkerParks ? 'B' : 'E')
+                    << "\", \"ts\": " << ts << ", \"pid\": 0, \"tid\": "
+                    << r.worker << "}";
+        break;
+      case FlightEvent::IngressDrain:
+        separator() << "{\"name\": \"ingress drain\", \"cat\": "
+                    << "\"Scheduler\", \"ph\": \"i\", \"ts\": " << ts
+                    << ", \"pid\": 0, \"tid\": " << r.worker
+                    << ", \"s\": \"t\", \"args\": {\"num_ingresses\": "
+                    << r.argument << "}}";
+        break;
+      case FlightEvent::LagSpike:
+        separator() << "{\"name\": \"lag spike\", \"cat\": \"Execution\", "
+                    << "\"ph\": \"i\", \"ts\": " << ts
+                    << ", \"pid\": 0, \"tid\": " << r.worker
+                    << ", \"s\": \"g\", \"cname\": \"terrible\", \"args\": "
+                    << "{\"lag_ns\": " << r.argument << "}}";
+        break;
+    }
+  }
+
+  // name processes and threads
+  separator() << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, "
+              << "\"args\": {\"name\": \"Execution\"}}";
+  for (const auto& kv : ids) {
+    separator() << "{\"name\": \"process_name\", \"ph\": \"M\", \"pid\": "
+                << kv.second.pid << ", \"args\": {\"name\": \""
+                << escape(kv.first->fqn()) << "\"}}";
+    for (const auto& element : kv.second.tids) {
+      separator() << "{\"name\": \"thread_name\", \"ph\": \"M\", "
+                  << "\"pid\": " << kv.second.pid << ", \"tid\": "
+                  << element.second << ", \"args\": {\"name\": \""
+                  << escape(element.first->name()) << "\"}}";
+    }
+  }
+
+  out << "\n], \"displayTimeUnit\": \"ns\"}\n";
+}
+
+}  // namespace reactor
@@ -0,0 +1,49 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include "reactor-cpp/mode.hh"
+
+#include "reactor-cpp/action.hh"
+#include "reactor-cpp/assert.hh"
+#include "reactor-cpp/environment.hh"
+#include "reactor-cpp/reaction.hh"
+
+#include <cassert>
+
+namespace reactor {
+
+Mode::Mode(const std::string& name, Reactor* container)
+    : ReactorElement(name, ReactorElement::Type::Mode, container) {}
+
+void Mode::declare_reaction(Reaction* reaction) {
+  assert(reaction != nullptr);
+  reactor::validate(this->environment()->allows_assembly(),
+           "Mode reactions may only be declared during assembly phase!");
+  reactor::validate(this->container() == reaction->container(),
+           "Mode reactions must belong to the same reactor as the mode");
+  reactor::validate(reaction->_mode == nullptr,
+           "A reaction may only belong to a single mode");
+
+  _reactions.insert(reaction);
+  reaction->_mode = this;
+}
+
+void Mode::declare_timer(Timer* timer) {
+  assert(timer != nullptr);
+  reactor::validate(this->environment()->allows_assembly(),
+           "Mode timers may only be declared during assembly phase!");
+  reactor::validate(this->container() == timer->container(),
+           "Mode timers must belong to the same reactor as the mode");
+  reactor::validate(timer->_mode == nullptr,
+           "A timer may only belong to a single mode");
+
+  _timers.insert(timer);
+  timer->_mode = this;
+}
+
+}  // namespace reactor
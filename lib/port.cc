@@ -12,6 +12,7 @@
 #include "reactor-cpp/environment.hh"
 #include "reactor-cpp/reaction.hh"
 
+#include <algorithm>
 #include <cassert>
 
 namespace reactor {
@@ -24,8 +25,8 @@ void BasePort::base_bind_to(BasePort* port) {
            "Ports with dependencies may not be connected to other ports");
   reactor::validate(!port->has_antidependencies(),
            "Ports with antidependencies may not be connected to other ports");
-  reactor::validate(this->environment()->phase() == Environment::Phase::Construction,
-           "Ports can only be bound during contruction phase!");
+  reactor::validate(this->environment()->allows_construction(),
+           "Ports can only be bound during contruction or mutation phase!");
 
   if (this->is_input() && port->is_input()) {
     reactor::validate(
@@ -49,7 +50,98 @@ void BasePort::base_bind_to(BasePort* port) {
   }
 
   port->_inward_binding = this;
-  assert(this->_outward_bindings.insert(port).second);
+  this->_outward_bindings.push_back(port);
+  this->environment()->mark_port_changed(port);
+}
+
+/**
+ * Bind num_to ports to num_from ports following a regular pattern.
+ *
+ * The port to[j] is bound to from[(j / group_size) % num_from]. num_to needs
+ * to be a multiple of num_from. Instead of validating each binding
+ * individually, all ports on each side are checked to be of the same kind and
+ * to belong to the same level of hierarchy. This allows to check the binding
+ * rules only once per pattern.
+ */
+void BasePort::base_bind_bulk(BasePort* const* from,
+                              std::size_t num_from,
+                              BasePort* const* to,
+                              std::size_t num_to,
+                              std::size_t group_size) {
+  reactor::validate(num_from > 0 && group_size > 0 && num_to % num_from == 0,
+           "The number of bound ports must be a multiple of the number of "
+           "source ports!");
+  if (num_to == 0) {
+    return;
+  }
+
+  auto environment = from[0]->environment();
+  reactor::validate(environment->allows_construction(),
+           "Ports can only be bound during contruction or mutation phase!");
+
+  // Bindings connect ports of reactors that share a common container. For
+  // output ports on the source side and input ports on the sink side, this
+  // is the container of their reactor. Otherwise it is the reactor owning
+  // the port.
+  auto anchor = [](BasePort* port, bool is_source) {
+    return port->is_output() == is_source ? port->container()->container()
+                                          : port->container();
+  };
+  const auto from_type = from[0]->type;
+  const auto to_type = to[0]->type;
+  const auto common_container = anchor(from[0], true);
+
+  bool valid = !(from_type == PortType::Input && to_type == PortType::Output);
+  for (std::size_t i = 0; i < num_from; i++) {
+    auto p = from[i];
+    valid &= p->environment() == environment && p->type == from_type &&
+             anchor(p, true) == common_container && !p->has_dependencies();
+  }
+  for (std::size_t j = 0; j < num_to; j++) {
+    auto p = to[j];
+    valid &= p->environment() == environment && p->type == to_type &&
+             anchor(p, false) == common_container &&
+             !p->has_inward_binding() && !p->has_antidependencies();
+    if (from_type == PortType::Output && to_type == PortType::Input) {
+      valid &= p->container() != from[(j / group_size) % num_from]->container();
+    }
+  }
+  // each sink may only be bound once
+  std::vector<BasePort*> sinks{to, to + num_to};
+  std::sort(sinks.begin(), sinks.end());
+  valid &= std::adjacent_find(sinks.begin(), sinks.end()) == sinks.end();
+  if (!valid) {
+    reactor::validate(false,
+             "Bulk bindings require ports of the same kind and hierarchy on "
+             "each side that follow the binding rules of bind_to() and sinks "
+             "that are bound only once!");
+  }
+
+  for (std::size_t i = 0; i < num_from; i++) {
+    from[i]->_outward_bindings.reserve(from[i]->_outward_bindings.size() +
+                                       num_to / num_from);
+  }
+  for (std::size_t j = 0; j < num_to; j++) {
+    auto source = from[(j / group_size) % num_from];
+    auto sink = to[j];
+    assert(!sink->has_inward_binding());
+    sink->_inward_binding = source;
+    source->_outward_bindings.push_back(sink);
+    environment->mark_port_changed(sink);
+  }
+}
+
+void BasePort::base_unbind_from(BasePort* port) {
+  assert(port != nullptr);
+  reactor::validate(this->environment()->phase() == Environment::Phase::Mutation,
+           "Ports can only be unbound during mutation phase!");
+  reactor::validate(port->inward_binding() == this,
+           "Ports can only be unbound from a port they are bound to!");
+
+  port->_inward_binding = nullptr;
+  _outward_bindings.erase(
+      std::find(_outward_bindings.begin(), _outward_bindings.end(), port));
+  this->environment()->mark_port_changed(port);
 }
 
 void BasePort::register_dependency(Reaction* reaction, bool is_trigger) {
@@ -57,7 +149,7 @@ void BasePort::register_dependency(Reaction* reaction, bool is_trigger) {
   assert(this->environment() == reaction->environment());
   reactor::validate(!this->has_outward_bindings(),
            "Dependencies may no be declared on ports with an outward binding!");
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
            "Dependencies can only be registered during assembly phase!");
 
   if (this->is_input()) {
@@ -69,9 +161,11 @@ void BasePort::register_dependency(Reaction* reaction, bool is_trigger) {
              "Dependent output ports must belong to a contained reactor");
   }
 
-  assert(_dependencies.insert(reaction).second);
+  [[maybe_unused]] bool result = _dependencies.insert(reaction).second;
+  assert(result);
   if (is_trigger) {
-    assert(_triggers.insert(reaction).second);
+    result = _triggers.insert(reaction).second;
+    assert(result);
   }
 }
 
@@ -81,7 +175,7 @@ void BasePort::register_antidependency(Reaction* reaction) {
   reactor::validate(
       !this->has_inward_binding(),
       "Antidependencies may no be declared on ports with an inward binding!");
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
            "Antidependencies can only be registered during assembly phase!");
 
   if (this->is_output()) {
@@ -93,11 +187,51 @@ void BasePort::register_antidependency(Reaction* reaction) {
              "Antidependent input ports must belong to a contained reactor");
   }
 
-  assert(_antidependencies.insert(reaction).second);
+  [[maybe_unused]] bool result = _antidependencies.insert(reaction).second;
+  assert(result);
+}
+
+void BasePort::update_active_triggers() {
+  _active_triggers.clear();
+  for (auto r : _triggers) {
+    if (r->is_active()) {
+      _active_triggers.push_back(r);
+    }
+  }
+}
+
+const std::vector<Port<void>*>& Port<void>::typed_outward_bindings() const {
+  return reinterpret_cast<const std::vector<Port<void>*>&>(outward_bindings());
+}
+
+void Port<void>::bind_to(const std::vector<Port<void>*>& ports) {
+  Port<void>* from = this;
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(&from), 1,
+                 reinterpret_cast<BasePort* const*>(ports.data()),
+                 ports.size(), 1);
+}
+
+void Port<void>::bind_one_to_each(const std::vector<Port<void>*>& from,
+                                  const std::vector<Port<void>*>& to) {
+  reactor::validate(from.size() == to.size(),
+           "bind_one_to_each() requires the same number of ports on both "
+           "sides!");
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(from.data()), from.size(),
+                 reinterpret_cast<BasePort* const*>(to.data()), to.size(), 1);
+}
+
+void Port<void>::bind_repeated(const std::vector<Port<void>*>& from,
+                               const std::vector<Port<void>*>& to) {
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(from.data()), from.size(),
+                 reinterpret_cast<BasePort* const*>(to.data()), to.size(), 1);
 }
 
-const std::set<Port<void>*>& Port<void>::typed_outward_bindings() const {
-  return reinterpret_cast<const std::set<Port<void>*>&>(outward_bindings());
+void Port<void>::bind_interleaved(const std::vector<Port<void>*>& from,
+                                  const std::vector<Port<void>*>& to) {
+  auto group_size = from.empty() ? 0 : to.size() / from.size();
+  base_bind_bulk(reinterpret_cast<BasePort* const*>(from.data()), from.size(),
+                 reinterpret_cast<BasePort* const*>(to.data()), to.size(),
+                 group_size);
 }
 
 Port<void>* Port<void>::typed_inward_binding() const {
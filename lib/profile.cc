@@ -0,0 +1,80 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include "reactor-cpp/profile.hh"
+
+#include <algorithm>
+
+namespace reactor {
+
+namespace {
+
+constexpr unsigned sub_bucket_bits{4};
+constexpr std::int64_t sub_buckets{1 << sub_bucket_bits};
+
+std::size_t index_of(std::int64_t value) {
+  if (value < sub_buckets) {
+    return static_cast<std::size_t>(value);
+  }
+  unsigned exponent = 0;
+  while ((value >> (exponent + 1)) != 0) {
+    exponent++;
+  }
+  unsigned shift = exponent - sub_bucket_bits;
+  return static_cast<std::size_t>((shift + 1) * sub_buckets +
+                                  ((value >> shift) - sub_buckets));
+}
+
+// the center of the given bucket
+std::int64_t value_of(std::size_t index) {
+  auto i = static_cast<std::int64_t>(index);
+  if (i < sub_buckets) {
+    return i;
+  }
+  auto shift = i / sub_buckets - 1;
+  auto low = (sub_buckets + i % sub_buckets) << shift;
+  return low + ((std::int64_t{1} << shift) >> 1);
+}
+
+}  // namespace
+
+void DurationHistogram::add(Duration value) {
+  value = std::max(value, Duration::zero());
+  auto index = index_of(value.count());
+  if (index >= buckets.size()) {
+    buckets.resize(index + 1, 0);
+  }
+  buckets[index]++;
+  _count++;
+  _total += value;
+  _max = std::max(_max, value);
+}
+
+Duration DurationHistogram::mean() const {
+  return _count == 0 ? Duration::zero()
+                     : _total / static_cast<Duration::rep>(_count);
+}
+
+Duration DurationHistogram::percentile(double p) const {
+  auto rank = static_cast<std::uint64_t>(p / 100.0 * _count);
+  std::uint64_t seen{0};
+  for (std::size_t i = 0; i < buckets.size(); i++) {
+    seen += buckets[i];
+    if (seen > rank) {
+      return std::min(Duration(value_of(i)), _max);
+    }
+  }
+  return _max;
+}
+
+std::uint64_t ReactionProfile::critical(const Reaction* dependency) const {
+  auto it = _critical_dependencies.find(dependency);
+  return it == _critical_dependencies.end() ? 0 : it->second;
+}
+
+}  // namespace reactor
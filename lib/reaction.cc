@@ -11,6 +11,8 @@
 #include "reactor-cpp/action.hh"
 #include "reactor-cpp/assert.hh"
 #include "reactor-cpp/environment.hh"
+#include "reactor-cpp/flight_recorder.hh"
+#include "reactor-cpp/mode.hh"
 #include "reactor-cpp/port.hh"
 
 #include <cassert>
@@ -30,34 +32,35 @@ Reaction::Reaction(const std::string& name,
 void Reaction::declare_trigger(BaseAction* action) {
   assert(action != nullptr);
   assert(this->environment() == action->environment());
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
            "Triggers may only be declared during assembly phase!");
   reactor::validate(this->container() == action->container(),
            "Action triggers must belong to the same reactor as the triggered "
            "reaction");
 
-  assert(_action_triggers.insert(action).second);
+  [[maybe_unused]] bool result = _action_triggers.insert(action).second;
+  assert(result);
   action->register_trigger(this);
 }
 
 void Reaction::declare_schedulable_action(BaseAction* action) {
   assert(action != nullptr);
   assert(this->environment() == action->environment());
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
            "Scheduable actions may only be declared during assembly phase!");
   reactor::validate(this->container() == action->container(),
            "Scheduable actions must belong to the same reactor as the "
            "triggered reaction");
 
-  assert(_scheduable_actions.insert(action).second);
+  [[maybe_unused]] bool result = _scheduable_actions.insert(action).second;
+  assert(result);
   action->register_scheduler(this);
 }
 
 void Reaction::declare_trigger(BasePort* port) {
   assert(port != nullptr);
   assert(this->environment() == port->environment());
-  assert(this->environment()->phase() == Environment::Phase::Assembly);
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
         "Triggers may only be declared during assembly phase!");
 
   if (port->is_input()) {
@@ -70,15 +73,17 @@ void Reaction::declare_trigger(BasePort* port) {
         "Output port triggers must belong to a contained reactor");
   }
 
-  assert(_port_triggers.insert(port).second);
-  assert(_dependencies.insert(port).second);
+  [[maybe_unused]] bool result = _port_triggers.insert(port).second;
+  assert(result);
+  result = _dependencies.insert(port).second;
+  assert(result);
   port->register_dependency(this, true);
 }
 
 void Reaction::declare_dependency(BasePort* port) {
   assert(port != nullptr);
   assert(this->environment() == port->environment());
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
            "Dependencies may only be declared during assembly phase!");
 
   if (port->is_input()) {
@@ -90,14 +95,15 @@ void Reaction::declare_dependency(BasePort* port) {
              "Dependent output ports must belong to a contained reactor");
   }
 
-  assert(_dependencies.insert(port).second);
+  [[maybe_unused]] bool result = _dependencies.insert(port).second;
+  assert(result);
   port->register_dependency(this, false);
 }
 
 void Reaction::declare_antidependency(BasePort* port) {
   assert(port != nullptr);
   assert(this->environment() == port->environment());
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
+  reactor::validate(this->environment()->allows_assembly(),
            "Antidependencies may only be declared during assembly phase!");
 
   if (port->is_output()) {
@@ -109,16 +115,76 @@ void Reaction::declare_antidependency(BasePort* port) {
              "Antidependent input ports must belong to a contained reactor");
   }
 
-  assert(_antidependencies.insert(port).second);
+  [[maybe_unused]] bool result = _antidependencies.insert(port).second;
+  assert(result);
   port->register_antidependency(this);
 }
 
+void Reaction::declare_pure() {
+  reactor::validate(this->environment()->allows_assembly(),
+           "Reactions may only be declared pure during assembly phase!");
+  reactor::validate(!_changes_mode,
+           "Reactions that change modes may not be declared pure!");
+  _pure = true;
+}
+
+void Reaction::declare_state_partition(unsigned partition) {
+  reactor::validate(this->environment()->allows_assembly(),
+           "State partitions may only be declared during assembly phase!");
+  _partitioned = true;
+  _state_partition = partition;
+}
+
+void Reaction::declare_mode_change() {
+  reactor::validate(this->environment()->allows_assembly(),
+           "Mode changes may only be declared during assembly phase!");
+  reactor::validate(!this->container()->modes().empty(),
+           "Only reactions of a reactor with modes may change modes!");
+  reactor::validate(!_pure, "Pure reactions may not change modes!");
+  _changes_mode = true;
+}
+
+template <class T>
+bool intersects(const std::set<T>& a, const std::set<T>& b) {
+  for (auto x : a) {
+    if (b.count(x) != 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Reaction::conflicts_with(const Reaction* reaction) const {
+  assert(this->container() == reaction->container());
+  // reactions of different modes never execute within the same tag
+  if (_mode != nullptr && reaction->_mode != nullptr &&
+      _mode != reaction->_mode) {
+    return false;
+  }
+  if (_changes_mode || reaction->_changes_mode) {
+    return true;
+  }
+  if (!_partitioned || !reaction->_partitioned ||
+      _state_partition == reaction->_state_partition) {
+    return true;
+  }
+  return intersects(_antidependencies, reaction->_antidependencies) ||
+         intersects(_scheduable_actions, reaction->_scheduable_actions);
+}
+
+bool Reaction::is_active() const {
+  return !_pruned && (_mode == nullptr || _mode->is_active());
+}
+
 void Reaction::trigger() {
   if (has_deadline()) {
     assert(deadline_handler != nullptr);
     auto lag =
         container()->get_physical_time() - container()->get_logical_time();
     if (lag > deadline) {
+      if constexpr (flight_recorder_enabled) {
+        flight_recorder().deadline_missed(this, lag);
+      }
       deadline_handler();
       return;
     }
@@ -136,8 +202,9 @@ void Reaction::set_deadline_impl(Duration dl,
 }
 
 void Reaction::set_index(unsigned index) {
-  reactor::validate(this->environment()->phase() == Environment::Phase::Assembly,
-           "Reaction indexes may only be set during assembly phase!");
+  reactor::validate(this->environment()->allows_assembly(),
+           "Reaction indexes may only be set during assembly or mutation "
+           "phase!");
   this->_index = index;
 }
 
@@ -12,6 +12,7 @@
 #include "reactor-cpp/assert.hh"
 #include "reactor-cpp/environment.hh"
 #include "reactor-cpp/logging.hh"
+#include "reactor-cpp/mode.hh"
 #include "reactor-cpp/port.hh"
 #include "reactor-cpp/reaction.hh"
 
@@ -26,8 +27,15 @@ ReactorElement::ReactorElement(const std::string& name,
   assert(container != nullptr);
   this->_environment = container->environment();
   assert(this->_environment != nullptr);
-  reactor::validate(this->_environment->phase() == Environment::Phase::Construction,
-           "Reactor elements can only be created during construction phase!");
+  reactor::validate(this->_environment->allows_construction(),
+           "Reactor elements can only be created during construction or "
+           "mutation phase!");
+  // Only new reactors are assembled and added to the dependency graph by a
+  // mutation.
+  reactor::validate(
+      this->_environment->phase() != Environment::Phase::Mutation ||
+          this->_environment->is_added_by_mutation(container),
+      "Mutations may only create elements within new top level reactors!");
   // We need a reinterpret_cast here as the derived class is not yet created
   // when this constructor is executed. dynamic_cast only works for
   // completely constructed objects. Technically, the casts here return
@@ -39,8 +47,12 @@ ReactorElement::ReactorElement(const std::string& name,
     case Type::Action:
       container->register_action(reinterpret_cast<BaseAction*>(this));
       break;
-    case Type::Port:
-      container->register_port(reinterpret_cast<BasePort*>(this));
+    case Type::Mode:
+      container->register_mode(reinterpret_cast<Mode*>(this));
+      break;
+    case Type::Input:
+    case Type::Output:
+      container->register_port(reinterpret_cast<BasePort*>(this), type);
       break;
     case Type::Reaction:
       container->register_reaction(reinterpret_cast<Reaction*>(this));
@@ -64,8 +76,9 @@ ReactorElement::ReactorElement(const std::string& name,
   assert(environment != nullptr);
   reactor::validate(type == Type::Reactor,
            "Only reactors can be owned by the environment!");
-  reactor::validate(this->_environment->phase() == Environment::Phase::Construction,
-           "Reactor elements can only be created during construction phase!");
+  reactor::validate(this->_environment->allows_construction(),
+           "Reactor elements can only be created during construction or "
+           "mutation phase!");
 }
 
 Reactor::Reactor(const std::string& name, Reactor* container)
@@ -78,38 +91,64 @@ Reactor::Reactor(const std::string& name, Environment* environment)
 void Reactor::register_action(BaseAction* action) {
   UNUSED(action);
   assert(action != nullptr);
-  reactor::validate(this->environment()->phase() == Environment::Phase::Construction,
-           "Actions can only be registered during construction phase!");
-  assert(_actions.insert(action).second);
+  reactor::validate(this->environment()->allows_construction(),
+           "Actions can only be registered during construction or mutation "
+           "phase!");
+  [[maybe_unused]] bool result = _actions.insert(action).second;
+  assert(result);
+}
+void Reactor::register_mode(Mode* mode) {
+  assert(mode != nullptr);
+  reactor::validate(this->environment()->allows_construction(),
+           "Modes can only be registered during construction or mutation "
+           "phase!");
+  _modes.insert(mode);
+  // the first mode is the initial mode
+  if (_active_mode == nullptr) {
+    _active_mode = mode;
+    _next_mode = mode;
+  }
 }
-void Reactor::register_port(BasePort* port) {
+void Reactor::register_port(BasePort* port, Type type) {
+  UNUSED(port);
   assert(port != nullptr);
-  reactor::validate(this->environment()->phase() == Environment::Phase::Construction,
-           "Ports can only be registered during construction phase!");
-  if (port->is_input()) {
-    assert(_inputs.insert(port).second);
+  reactor::validate(this->environment()->allows_construction(),
+           "Ports can only be registered during construction or mutation "
+           "phase!");
+  // The port is not yet fully constructed, so we cannot ask it for its type.
+  if (type == Type::Input) {
+    [[maybe_unused]] bool result = _inputs.insert(port).second;
+    assert(result);
   } else {
-    assert(_outputs.insert(port).second);
+    [[maybe_unused]] bool result = _outputs.insert(port).second;
+    assert(result);
   }
 }
 void Reactor::register_reaction(Reaction* reaction) {
   UNUSED(reaction);
   assert(reaction != nullptr);
-  reactor::validate(this->environment()->phase() == Environment::Phase::Construction,
-           "Reactions can only be registered during construction phase!");
-  assert(_reaction.insert(reaction).second);
+  reactor::validate(this->environment()->allows_construction(),
+           "Reactions can only be registered during construction or mutation "
+           "phase!");
+  [[maybe_unused]] bool result = _reactions.insert(reaction).second;
+  assert(result);
 }
 void Reactor::register_reactor(Reactor* reactor) {
   UNUSED(reactor);
   assert(reactor != nullptr);
-  reactor::validate(this->environment()->phase() == Environment::Phase::Construction,
-           "Reactions can only be registered during construction phase!");
-  assert(_reactors.insert(reactor).second);
+  reactor::validate(this->environment()->allows_construction(),
+           "Reactions can only be registered during construction or mutation "
+           "phase!");
+  [[maybe_unused]] bool result = _reactors.insert(reactor).second;
+  assert(result);
 }
 
 void Reactor::startup() {
-  assert(environment()->phase() == Environment::Phase::Startup);
+  assert(environment()->phase() == Environment::Phase::Startup ||
+         environment()->phase() == Environment::Phase::Mutation);
   log::Debug() << "Starting up reactor " << fqn();
+  // determine which reactions may be triggered in the initial mode
+  update_active_triggers();
   // call startup on all contained objects
   for (auto x : _actions)
     x->startup();
@@ -139,6 +178,59 @@ void Reactor::shutdown() {
     x->shutdown();
 }
 
+void Reactor::set_mode(Mode* mode) {
+  assert(mode != nullptr);
+  reactor::validate(mode->container() == this,
+           "set_mode() may only be called with modes of the same reactor!");
+  reactor::validate(environment()->phase() == Environment::Phase::Execution,
+           "Modes may only be changed during execution phase!");
+  // Reactions that declared a mode change never execute concurrently with
+  // other reactions of this reactor, so no two of them race on _next_mode.
+  auto reaction = Worker::current_reaction;
+  reactor::validate(reaction != nullptr && reaction->container() == this &&
+                        reaction->changes_mode(),
+           "Modes may only be changed by reactions of the same reactor that "
+           "declared a mode change!");
+  if (mode != _next_mode) {
+    // the new mode becomes active after the current tag was processed
+    _next_mode = mode;
+    environment()->scheduler()->register_mode_change(this);
+  }
+}
+
+void Reactor::update_active_triggers() {
+  // Reactions of this reactor may be triggered by its actions, its inputs and
+  // the outputs of contained reactors
+  for (auto x : _actions)
+    x->update_active_triggers();
+  for (auto x : _inputs)
+    x->update_active_triggers();
+  for (auto r : _reactors) {
+    for (auto x : r->outputs())
+      x->update_active_triggers();
+  }
+}
+
+void Reactor::apply_mode_change() {
+  if (_next_mode == _active_mode) {
+    return;
+  }
+  log::Debug() << "Reactor " << fqn() << " switches to mode "
+               << _next_mode->name();
+
+  // stop all timers of the old mode
+  std::set<BaseAction*> timers{_active_mode->timers().begin(),
+                               _active_mode->timers().end()};
+  environment()->scheduler()->remove_events(timers);
+
+  _active_mode = _next_mode;
+  update_active_triggers();
+
+  // restart all timers of the new mode
+  for (auto t : _active_mode->timers())
+    t->restart();
+}
+
 TimePoint Reactor::get_physical_time() const {
   return ::reactor::get_physical_time();
 }
@@ -11,16 +11,29 @@
 #include "reactor-cpp/action.hh"
 #include "reactor-cpp/assert.hh"
 #include "reactor-cpp/environment.hh"
+#include "reactor-cpp/flight_recorder.hh"
 #include "reactor-cpp/logging.hh"
 #include "reactor-cpp/port.hh"
 #include "reactor-cpp/reaction.hh"
 #include "reactor-cpp/trace.hh"
+#include "reactor-cpp/trace_filter.hh"
 
+#include <algorithm>
 #include <cassert>
 
 namespace reactor {
 
 thread_local const Worker* Worker::current_worker{nullptr};
+thread_local const Reaction* Worker::current_reaction{nullptr};
+
+namespace {
+
+// the scheduler whose task is executed by the current thread, and the number
+// of tasks that its executor ran synchronously in the meantime
+thread_local const Scheduler* task_scheduler{nullptr};
+thread_local std::size_t deferred_tasks{0};
+
+}  // namespace
 
 Worker::Worker(Worker&& w) : scheduler{w.scheduler}, id{w.id}, thread{} {
   // Need to provide the move constructor in order to organize workers in a
@@ -61,6 +74,7 @@ void Worker::work() const {
             1, std::memory_order_acq_rel) == 1) {
       // Yes, then schedule. The atomic decrement above ensures that only one
       // thread enters this block.
+      scheduler.last_reaction = reaction;
       scheduler.schedule();
     }
     // continue otherwise
@@ -72,22 +86,65 @@ void Worker::work() const {
 void Worker::execute_reaction(Reaction* reaction) const {
   log::Debug() << "(Worker " << id << ") "
                << "execute reaction " << reaction->fqn();
-  tracepoint(reactor_cpp, reaction_execution_starts, id, reaction->fqn());
-  reaction->trigger();
-  tracepoint(reactor_cpp, reaction_execution_finishes, id, reaction->fqn());
+  // decide once so that start and finish are always recorded in pairs
+  bool traced = trace_accepts(TraceEvent::ReactionExecution, reaction);
+  if (traced) {
+    tracepoint(reactor_cpp, reaction_execution_starts, id, reaction->fqn());
+  }
+  if constexpr (flight_recorder_enabled) {
+    flight_recorder().record(FlightEvent::ReactionExecutionStarts, reaction);
+  }
+  auto environment = scheduler._environment;
+  current_reaction = reaction;
+  if (environment->profiling()) {
+    auto start = get_physical_time();
+    reaction->trigger();
+    environment->profile_execution(reaction, start, get_physical_time());
+  } else {
+    reaction->trigger();
+  }
+  current_reaction = nullptr;
+  if constexpr (flight_recorder_enabled) {
+    flight_recorder().record(FlightEvent::ReactionExecutionFinishes, reaction);
+  }
+  if (traced) {
+    tracepoint(reactor_cpp, reaction_execution_finishes, id, reaction->fqn());
+  }
 }
 
 void Scheduler::schedule() {
+  if (level_width > 0) {
+    if (trace_accepts(TraceEvent::Level)) {
+      tracepoint(reactor_cpp, level_finishes, Worker::current_worker_id(),
+                 level, level_width);
+    }
+    if constexpr (flight_recorder_enabled) {
+      flight_recorder().record(
+          FlightEvent::LevelFinishes, nullptr, TimePoint{},
+          (std::uint64_t{level} << 32) | level_width);
+    }
+    level_width = 0;
+  }
+
   bool found_ready_reactions = schedule_ready_reactions();
 
+  // all reactions of the current tag are processed
+  if (!found_ready_reactions && last_reaction != nullptr) {
+    if (_environment->profiling()) {
+      _environment->profile_critical_path(last_reaction);
+    }
+    last_reaction = nullptr;
+  }
+
   while (!found_ready_reactions) {
+    finish_tag();
     log::Debug() << "(Scheduler) call next()";
     next();
-    reaction_queue_pos = 0;
 
     found_ready_reactions = schedule_ready_reactions();
 
     if (!continue_execution && !found_ready_reactions) {
+      finish_tag();
       // let all workers know that they should terminate
       terminate_all_workers();
       break;
@@ -102,7 +159,19 @@ Reaction* ReadyQueue::pop() {
   while (old_size <= 0) {
     log::Debug() << "(Worker " << Worker::current_worker_id()
                  << ") Wait for work";
+    if (trace_accepts(TraceEvent::WorkerPark)) {
+      tracepoint(reactor_cpp, worker_parks, Worker::current_worker_id());
+    }
+    if constexpr (flight_recorder_enabled) {
+      flight_recorder().record(FlightEvent::WorkerParks, nullptr);
+    }
     sem.acquire();
+    if (trace_accepts(TraceEvent::WorkerPark)) {
+      tracepoint(reactor_cpp, worker_unparks, Worker::current_worker_id());
+    }
+    if constexpr (flight_recorder_enabled) {
+      flight_recorder().record(FlightEvent::WorkerUnparks, nullptr);
+    }
     log::Debug() << "(Worker " << Worker::current_worker_id() << ") Waking up";
     old_size = size.fetch_sub(1, std::memory_order_acq_rel);
     // FIXME: Protect against underflow?
@@ -145,6 +214,13 @@ void ReadyQueue::fill_up(std::vector<Reaction*>& ready_reactions) {
 }
 
 void Scheduler::terminate_all_workers() {
+  if (executor != nullptr) {
+    // tasks terminate once they run out of reactions
+    std::lock_guard<std::mutex> lg(m_executor);
+    executor_terminated = true;
+    return;
+  }
+
   log::Debug() << "(Scheduler) Send termination signal to all workers";
   auto num_workers = _environment->num_workers();
   std::vector<Reaction*> null_reactions{num_workers, nullptr};
@@ -153,63 +229,74 @@ void Scheduler::terminate_all_workers() {
 }
 
 bool Scheduler::schedule_ready_reactions() {
-  // insert any triggered reactions into the reaction queue
+  // pass any triggered reactions on to the scheduling policy
   for (auto& v : triggered_reactions) {
     for (auto n : v) {
-      reaction_queue[n->index()].push_back(n);
+      policy->trigger(n);
     }
     v.clear();
   }
 
   log::Debug() << "(Scheduler) "
-               << "Scanning the reaction queue for ready reactions";
-
-  // continue iterating over the reaction queue
-  for (; reaction_queue_pos < reaction_queue.size(); reaction_queue_pos++) {
-    auto& reactions = reaction_queue[reaction_queue_pos];
-
-    // any ready reactions of current priority?
-    if (!reactions.empty()) {
-      log::Debug() << "(Scheduler) Process reactions of priority "
-                   << reaction_queue_pos;
-
-      // Make sure that any reaction is only executed once even if it
-      // was triggered multiple times.
-      std::sort(reactions.begin(), reactions.end());
-      reactions.erase(std::unique(reactions.begin(), reactions.end()),
-                      reactions.end());
-
-      if constexpr (log::debug_enabled || tracing_enabled) {
-        for (auto r : reactions) {
-          log::Debug() << "(Scheduler) Reaction " << r->fqn()
-                       << " is ready for execution";
-          tracepoint(reactor_cpp, trigger_reaction, r->container()->fqn(),
-                     r->name(), _logical_time);
-        }
-      }
+               << "Ask the scheduling policy for ready reactions";
 
-      reactions_to_process.store(reactions.size(), std::memory_order_release);
-      ready_queue.fill_up(reactions);
+  if (!policy->next_ready(ready_reactions, level)) {
+    log::Debug() << "(Scheduler) No more reactions at the current tag";
+    return false;
+  }
 
-      // break out of the loop and return
-      return true;
+  log::Debug() << "(Scheduler) Process reactions of level " << level;
+
+  if constexpr (log::debug_enabled || tracing_enabled ||
+                flight_recorder_enabled) {
+    for (auto r : ready_reactions) {
+      log::Debug() << "(Scheduler) Reaction " << r->fqn()
+                   << " is ready for execution";
+      if (trace_accepts(TraceEvent::TriggerReaction, r)) {
+        tracepoint(reactor_cpp, trigger_reaction, r->container()->fqn(),
+                   r->name(), _logical_time);
+      }
+      if constexpr (flight_recorder_enabled) {
+        flight_recorder().record(FlightEvent::TriggerReaction, r,
+                                 _logical_time.time_point(),
+                                 _logical_time.micro_step());
+      }
     }
   }
 
-  log::Debug() << "(Scheduler) Reached end of reaction queue";
+  level_width = ready_reactions.size();
+  if (trace_accepts(TraceEvent::Level)) {
+    tracepoint(reactor_cpp, level_starts, Worker::current_worker_id(), level,
+               level_width);
+  }
+  if constexpr (flight_recorder_enabled) {
+    flight_recorder().record(FlightEvent::LevelStarts, nullptr, TimePoint{},
+                             (std::uint64_t{level} << 32) | level_width);
+  }
 
-  return false;
+  reactions_to_process.store(ready_reactions.size(),
+                             std::memory_order_release);
+  if (executor != nullptr) {
+    dispatch_to_executor(ready_reactions);
+  } else {
+    ready_queue.fill_up(ready_reactions);
+  }
+
+  return true;
 }
 
 void Scheduler::start() {
   log::Debug() << "Starting the scheduler...";
 
   auto num_workers = _environment->num_workers();
-  // initialize the reaction queue, set ports vector, and triggered reactions
-  // vector
-  reaction_queue.resize(_environment->max_reaction_index() + 1);
+  // initialize the scheduling policy, set ports vector, and triggered
+  // reactions vector
+  policy->update(*_environment);
   set_ports.resize(num_workers);
+  mode_changes.resize(num_workers);
   triggered_reactions.resize(num_workers);
+  scheduled_events.resize(num_workers);
+  tag_batch.reserve(tag_batch_size);
 
   // Initialize and start the workers. By resizing the workers vector first, we
   // make sure that there is sufficient space for all the workers and non of
@@ -218,7 +305,15 @@ void Scheduler::start() {
   workers.reserve(num_workers);
   for (unsigned i = 0; i < num_workers; i++) {
     workers.emplace_back(*this, i);
-    workers.back().start_thread();
+  }
+
+  if (executor != nullptr) {
+    start_on_executor();
+    return;
+  }
+
+  for (auto& w : workers) {
+    w.start_thread();
   }
 
   // join all worker threads
@@ -227,9 +322,129 @@ void Scheduler::start() {
   }
 }
 
-void Scheduler::next() {
-  static EventMap events{};
+void Scheduler::start_on_executor() {
+  log::Debug() << "Execute reactions on an external executor";
+  {
+    std::lock_guard<std::mutex> lg(m_executor);
+    // hand out worker 0 first
+    for (auto i = workers.size(); i > 0; i--) {
+      idle_workers.push_back(static_cast<unsigned>(i - 1));
+    }
+    active_tasks = 1;
+  }
+  executor->execute([this]() { run_task(true); });
+
+  // wait until the execution terminated and all tasks returned
+  std::unique_lock<std::mutex> lock{m_executor};
+  cv_executor.wait(lock,
+                   [this]() { return executor_terminated && active_tasks == 0; });
+}
+
+void Scheduler::dispatch_to_executor(std::vector<Reaction*>& ready_reactions) {
+  executor_queue.clear();
+  executor_queue.swap(ready_reactions);
+  auto size = executor_queue.size();
+  executor_cursor.store(std::uint64_t{size} << 32, std::memory_order_release);
+
+  // The calling task continues to execute reactions. Thus, one task less is
+  // needed.
+  auto tasks = std::min(size, workers.size()) - 1;
+  if (tasks > 0) {
+    {
+      std::lock_guard<std::mutex> lg(m_executor);
+      active_tasks += tasks;
+    }
+    for (std::size_t i = 0; i < tasks; i++) {
+      executor->execute([this]() { run_task(false); });
+    }
+  }
+}
 
+Reaction* Scheduler::claim_reaction() {
+  constexpr std::uint64_t index_mask{0xffffffff};
+  auto cursor = executor_cursor.load(std::memory_order_acquire);
+  while ((cursor & index_mask) < (cursor >> 32)) {
+    if (executor_cursor.compare_exchange_weak(cursor, cursor + 1,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_acquire)) {
+      // The queue is only replaced after all of its reactions were executed,
+      // which includes the one claimed here.
+      return executor_queue[cursor & index_mask];
+    }
+  }
+  return nullptr;
+}
+
+void Scheduler::run_task(bool initial) {
+  // An executor may run a task synchronously within execute(), which is
+  // called by tasks of this scheduler. Instead of recursing, which may
+  // overflow the stack, such tasks are executed after the calling task.
+  if (task_scheduler == this) {
+    deferred_tasks++;
+    return;
+  }
+  auto previous_scheduler = task_scheduler;
+  auto previous_deferred = deferred_tasks;
+  task_scheduler = this;
+  deferred_tasks = 0;
+  execute_task(initial);
+  while (deferred_tasks > 0) {
+    deferred_tasks--;
+    execute_task(false);
+  }
+  task_scheduler = previous_scheduler;
+  deferred_tasks = previous_deferred;
+}
+
+void Scheduler::execute_task(bool initial) {
+  auto previous_worker = Worker::current_worker;
+  while (true) {
+    unsigned id{0};
+    {
+      std::lock_guard<std::mutex> lg(m_executor);
+      if (idle_workers.empty() || executor_terminated) {
+        break;
+      }
+      id = idle_workers.back();
+      idle_workers.pop_back();
+    }
+
+    auto& worker = workers[id];
+    Worker::current_worker = &worker;
+    if (initial) {
+      initial = false;
+      schedule();
+    }
+    for (auto r = claim_reaction(); r != nullptr; r = claim_reaction()) {
+      worker.execute_reaction(r);
+      if (reactions_to_process.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        last_reaction = r;
+        schedule();
+      }
+    }
+    Worker::current_worker = previous_worker;
+
+    {
+      std::lock_guard<std::mutex> lg(m_executor);
+      idle_workers.push_back(id);
+    }
+
+    // Another task might have failed to claim a worker while this one was
+    // running out of reactions. Thus, check again after returning the worker.
+    auto cursor = executor_cursor.load(std::memory_order_acquire);
+    if ((cursor & 0xffffffff) >= (cursor >> 32)) {
+      break;
+    }
+  }
+
+  std::lock_guard<std::mutex> lg(m_executor);
+  active_tasks--;
+  if (executor_terminated && active_tasks == 0) {
+    cv_executor.notify_all();
+  }
+}
+
+void Scheduler::next() {
   // clean up before scheduling any new events
   if (!events.empty()) {
     // cleanup all triggered actions
@@ -246,27 +461,84 @@ void Scheduler::next() {
     events.clear();
   }
 
-  {
+  // apply all mode changes requested during the last tag
+  for (auto& v : mode_changes) {
+    for (auto r : v) {
+      r->apply_mode_change();
+    }
+    v.clear();
+  }
+
+  collect_scheduled_events();
+
+  // In fast forward mode, the next tag is taken from the current batch of
+  // tags without synchronizing with other threads, unless they scheduled
+  // events, requested a mutation or stopped the execution.
+  if (!_environment->fast_fwd_execution() ||
+      async_events_pending.load(std::memory_order_acquire) || _stop ||
+      _environment->mutations_pending() || ingress_pending() ||
+      !advance_to_batched_tag()) {
     std::unique_lock<std::mutex> lock{m_schedule};
+    bool sleep_hooks_invoked{false};
 
-    // shutdown if there are no more events in the queue
-    if (event_queue.empty() && !_stop) {
-      if (_environment->run_forever()) {
-        // wait for a new asynchronous event
-        cv_schedule.wait(lock,
-                         [this]() { return !event_queue.empty() || _stop; });
-      } else {
-        log::Debug() << "No more events in queue. -> Terminate!";
-        _environment->sync_shutdown();
-      }
-    }
+    // the remaining batched tags are handled along with the event queue
+    return_tag_batch();
 
     while (events.empty()) {
+      // collect events from all external sources
+      drain_ingresses();
+
+      // Apply any pending topology mutations. This is a safe point as no
+      // reactions are executing in between two tags.
+      if (_environment->mutations_pending()) {
+        if (!_environment->apply_mutations(lock)) {
+          // the dependency graph is invalid; stop without executing anything
+          _stop = true;
+          continue_execution = false;
+          return;
+        }
+        policy->update(*_environment);
+      }
+
+      collect_scheduled_events();
+      merge_async_events();
+
+      // shutdown if there are no more events in the queue
+      if (event_queue.empty() && !_stop) {
+        if (_environment->run_forever()) {
+          if (!sleep_hooks_invoked) {
+            sleep_hooks_invoked = true;
+            if (invoke_sleep_hooks(lock)) {
+              continue;
+            }
+          }
+          // wait for a new asynchronous event or mutation
+          trace_sleep_starts(TimePoint::max());
+          if (polled_ingresses.empty()) {
+            waiting_for_events.store(true);
+            cv_schedule.wait(lock, [this]() {
+              return !event_queue.empty() || async_events_pending.load() ||
+                     _stop || _environment->mutations_pending() ||
+                     ingress_pending();
+            });
+            waiting_for_events.store(false);
+          } else {
+            poll_until(lock, TimePoint::max());
+          }
+          trace_sleep_finishes();
+          continue;
+        } else {
+          log::Debug() << "No more events in queue. -> Terminate!";
+          _environment->sync_shutdown();
+          collect_scheduled_events();
+        }
+      }
+
       if (_stop) {
         continue_execution = false;
         log::Debug() << "Shutting down the scheduler";
         Tag t_next = Tag::from_logical_time(_logical_time).delay();
-        if (t_next == event_queue.begin()->first) {
+        if (!event_queue.empty() && t_next == event_queue.begin()->first) {
           log::Debug() << "Schedule the last round of reactions including all "
                           "termination reactions";
           events = std::move(event_queue.begin()->second);
@@ -274,6 +546,7 @@ void Scheduler::next() {
           log::Debug() << "advance logical time to tag [" << t_next.time_point()
                        << ", " << t_next.micro_step() << "]";
           _logical_time.advance_to(t_next);
+          trace_tag_advance(t_next);
         } else {
           return;
         }
@@ -283,9 +556,6 @@ void Scheduler::next() {
 
         // synchronize with physical time if not in fast forward mode
         if (!_environment->fast_fwd_execution()) {
-          // keep track of the current physical time in a static variable
-          static auto physical_time = TimePoint::min();
-
           // If physical time is smaller than the next logical time point,
           // then update the physical time. This step is small optimization to
           // avoid calling get_physical_time() in every iteration as this
@@ -297,7 +567,24 @@ void Scheduler::next() {
           // point, then wait until the next tag or until a new event is
           // inserted asynchronously into the queue
           if (physical_time < t_next.time_point()) {
-            auto status = cv_schedule.wait_until(lock, t_next.time_point());
+            if (!sleep_hooks_invoked) {
+              sleep_hooks_invoked = true;
+              if (invoke_sleep_hooks(lock)) {
+                continue;
+              }
+            }
+            trace_sleep_starts(t_next.time_point());
+            auto status = std::cv_status::no_timeout;
+            if (polled_ingresses.empty()) {
+              waiting_for_events.store(true);
+              if (!ingress_pending()) {
+                status = cv_schedule.wait_until(lock, t_next.time_point());
+              }
+              waiting_for_events.store(false);
+            } else if (!poll_until(lock, t_next.time_point())) {
+              status = std::cv_status::timeout;
+            }
+            trace_sleep_finishes();
             // Start over if the event queue was modified
             if (status == std::cv_status::no_timeout) {
               continue;
@@ -317,6 +604,13 @@ void Scheduler::next() {
         log::Debug() << "advance logical time to tag [" << t_next.time_point()
                      << ", " << t_next.micro_step() << "]";
         _logical_time.advance_to(t_next);
+        trace_tag_advance(t_next);
+
+        if (_environment->fast_fwd_execution()) {
+          fill_tag_batch();
+        } else if constexpr (flight_recorder_enabled) {
+          flight_recorder().check_lag(_logical_time);
+        }
       }
     }
   }  // mutex m_schedule
@@ -333,20 +627,124 @@ void Scheduler::next() {
   log::Debug() << "events: " << events.size();
   for (auto& kv : events) {
     log::Debug() << "Action " << kv.first->fqn();
-    for (auto n : kv.first->triggers()) {
+    for (auto n : kv.first->active_triggers()) {
       // There is no need to acquire the mutex. At this point the scheduler
-      // should be the only thread accessing the reaction queue as none of the
-      // workers are running
+      // should be the only thread accessing the scheduling policy as none of
+      // the workers are running
       log::Debug() << "insert reaction " << n->fqn() << " with index "
                    << n->index();
-      reaction_queue[n->index()].push_back(n);
+      policy->trigger(n);
+    }
+  }
+
+  tag_in_progress = true;
+  for (auto hook : tag_hooks) {
+    hook->tag_starts(_logical_time);
+  }
+}
+
+void Scheduler::fill_tag_batch() {
+  // Move the following tags out of the event queue in one pass, so that the
+  // event queue is not modified for each tag.
+  auto it = event_queue.begin();
+  for (std::size_t i = 0; i < tag_batch_size && it != event_queue.end();
+       i++, it++) {
+    tag_batch.emplace_back(it->first, std::move(it->second));
+  }
+  event_queue.erase(event_queue.begin(), it);
+}
+
+void Scheduler::return_tag_batch() {
+  for (auto i = tag_batch_pos; i < tag_batch.size(); i++) {
+    auto& batched = tag_batch[i];
+    auto result = event_queue.try_emplace(batched.first,
+                                          std::move(batched.second));
+    if (!result.second) {
+      // Events in the queue were scheduled after the batch was taken. Thus,
+      // they take precedence over batched events of the same action.
+      result.first->second.merge(batched.second);
+    }
+  }
+  tag_batch.clear();
+  tag_batch_pos = 0;
+}
+
+bool Scheduler::advance_to_batched_tag() {
+  if (tag_batch_pos == tag_batch.size()) {
+    // The event queue is only accessed by the scheduler in between two tags.
+    // Thus, no lock is needed to take the next batch.
+    if (event_queue.empty()) {
+      return false;
+    }
+    fill_tag_batch();
+  }
+
+  // Reactions of the previous tag may have scheduled events at a tag that is
+  // earlier than the next batched one, or at the same tag. Those events are
+  // in the event queue.
+  auto queued = event_queue.begin();
+  auto& batched = tag_batch[tag_batch_pos];
+  if (queued != event_queue.end() && queued->first < batched.first) {
+    auto node = event_queue.extract(queued);
+    events = std::move(node.mapped());
+    log::Debug() << "advance logical time to tag ["
+                 << node.key().time_point() << ", " << node.key().micro_step()
+                 << "]";
+    _logical_time.advance_to(node.key());
+    trace_tag_advance(node.key());
+    return true;
+  }
+
+  events = std::move(batched.second);
+  if (queued != event_queue.end() && queued->first == batched.first) {
+    // events that were scheduled later take precedence
+    for (auto& kv : queued->second) {
+      events[kv.first] = std::move(kv.second);
+    }
+    event_queue.erase(queued);
+  }
+  log::Debug() << "advance logical time to tag [" << batched.first.time_point()
+               << ", " << batched.first.micro_step() << "]";
+  _logical_time.advance_to(batched.first);
+  trace_tag_advance(batched.first);
+
+  if (++tag_batch_pos == tag_batch.size()) {
+    tag_batch.clear();
+    tag_batch_pos = 0;
+  }
+  return true;
+}
+
+void Scheduler::finish_tag() {
+  if (tag_in_progress) {
+    tag_in_progress = false;
+    for (auto hook : tag_hooks) {
+      hook->tag_finishes(_logical_time);
     }
   }
 }
 
+bool Scheduler::invoke_sleep_hooks(std::unique_lock<std::mutex>& lock) {
+  if (tag_hooks.empty()) {
+    return false;
+  }
+
+  // Do not block other threads while the hooks perform I/O. The caller needs
+  // to check for new events if any arrived in the meantime, as notifications
+  // are missed while the lock is released.
+  lock.unlock();
+  for (auto hook : tag_hooks) {
+    hook->before_sleep();
+  }
+  lock.lock();
+  return async_events_pending.load(std::memory_order_acquire) || _stop ||
+         _environment->mutations_pending();
+}
+
 Scheduler::Scheduler(Environment* env)
     : using_workers(env->num_workers() > 1)
     , _environment(env)
+    , policy(std::make_unique<LevelPolicy>())
     , ready_queue(env->num_workers()) {}
 
 Scheduler::~Scheduler() {}
@@ -362,20 +760,124 @@ void Scheduler::schedule_sync(const Tag& tag,
                                         : " asynchronously ")
                << " with tag [" << tag.time_point() << ", " << tag.micro_step()
                << "]";
-  {
-    auto lg = using_workers ? std::unique_lock<std::mutex>(m_event_queue)
-                            : std::unique_lock<std::mutex>();
 
+  if (trace_accepts(TraceEvent::ScheduleAction, action)) {
     tracepoint(reactor_cpp, schedule_action, action->container()->fqn(),
                action->name(), tag);
+  }
+  if constexpr (flight_recorder_enabled) {
+    flight_recorder().record(FlightEvent::ScheduleAction, action,
+                             tag.time_point(), tag.micro_step());
+  }
+
+  auto worker = Worker::current_worker;
+  if (worker == nullptr || &worker->scheduler != this) {
+    // Threads other than the workers, including the workers of other
+    // environments, need to hold m_schedule (or call this before the
+    // execution starts).
+    async_event_queue.try_emplace(tag, EventMap()).first->second[action] =
+        std::move(setup);
+    async_events_pending.store(true, std::memory_order_release);
+  } else if (using_workers) {
+    // stage the event until the scheduler collects it in between two tags
+    scheduled_events[worker->id].push_back(
+        {tag, action, std::move(setup)});
+  } else {
+    // a single worker may insert directly
+    event_queue.try_emplace(tag, EventMap()).first->second[action] =
+        std::move(setup);
+  }
+}
 
-    // create a new event map or retrieve the existing one
-    auto emplace_result = event_queue.try_emplace(tag, EventMap());
-    auto& event_map = emplace_result.first->second;
+void Scheduler::schedule_sync(BaseAction* action, EventList& events) {
+  if (events.empty()) {
+    return;
+  }
+
+  // Tags are not assignable, thus sort pointers to the events instead. The
+  // order of events with the same tag is kept, so that the last one wins.
+  auto by_tag = [](const auto* a, const auto* b) { return a->first < b->first; };
+  std::vector<EventList::value_type*> sorted;
+  sorted.reserve(events.size());
+  for (auto& e : events) {
+    sorted.push_back(&e);
+  }
+  if (!std::is_sorted(sorted.begin(), sorted.end(), by_tag)) {
+    std::stable_sort(sorted.begin(), sorted.end(), by_tag);
+  }
+  assert(_logical_time < sorted.front()->first);
+  log::Debug() << "Schedule action " << action->fqn() << " "
+               << events.size() << " times";
+
+  if constexpr (tracing_enabled || flight_recorder_enabled) {
+    for (auto e : sorted) {
+      const auto& tag = e->first;
+      if (trace_accepts(TraceEvent::ScheduleAction, action)) {
+        tracepoint(reactor_cpp, schedule_action, action->container()->fqn(),
+                   action->name(), tag);
+      }
+      if constexpr (flight_recorder_enabled) {
+        flight_recorder().record(FlightEvent::ScheduleAction, action,
+                                 tag.time_point(), tag.micro_step());
+      }
+    }
+  }
+
+  auto worker = Worker::current_worker;
+  if (worker != nullptr && &worker->scheduler == this && using_workers) {
+    auto& staged = scheduled_events[worker->id];
+    for (auto e : sorted) {
+      staged.push_back({e->first, action, std::move(e->second)});
+    }
+    return;
+  }
+
+  // Insert each tag right before the position following the previous one,
+  // which takes amortized constant time if the tags are close.
+  bool async = worker == nullptr || &worker->scheduler != this;
+  auto& queue = async ? async_event_queue : event_queue;
+  auto hint = queue.begin();
+  for (auto e : sorted) {
+    auto it = queue.try_emplace(hint, e->first, EventMap());
+    it->second[action] = std::move(e->second);
+    hint = std::next(it);
+  }
+  if (async) {
+    async_events_pending.store(true, std::memory_order_release);
+  }
+}
 
-    // insert the new event
-    event_map[action] = setup;
+void Scheduler::collect_scheduled_events() {
+  // Events staged by the same worker are inserted in the order they were
+  // scheduled, so that the last one wins as if it was inserted directly.
+  // Consecutive events are often scheduled in order, e.g., by
+  // LogicalAction::schedule_many(). Thus, use the previous position as a
+  // hint.
+  for (auto& v : scheduled_events) {
+    auto hint = event_queue.begin();
+    for (auto& e : v) {
+      auto it = event_queue.try_emplace(hint, e.tag, EventMap());
+      it->second[e.action] = std::move(e.setup);
+      hint = std::next(it);
+    }
+    v.clear();
+  }
+}
+
+void Scheduler::merge_async_events() {
+  if (!async_events_pending.load(std::memory_order_relaxed)) {
+    return;
+  }
+  async_events_pending.store(false, std::memory_order_relaxed);
+  // moves all nodes with tags that are not yet in the event queue
+  event_queue.merge(async_event_queue);
+  for (auto& kv : async_event_queue) {
+    auto& event_map = event_queue.find(kv.first)->second;
+    for (auto& event : kv.second) {
+      event_map[event.first] = std::move(event.second);
+    }
   }
+  async_event_queue.clear();
 }
 
 void Scheduler::schedule_async(const Tag& tag,
@@ -400,17 +902,168 @@ void Scheduler::set_port(BasePort* p) {
 
 void Scheduler::set_port_helper(BasePort* p) {
   assert(!(p->has_outward_bindings() && !p->triggers().empty()));
+  if (p->records_history) {
+    p->record_history();
+  }
   if (p->has_outward_bindings()) {
     for (auto binding : p->outward_bindings()) {
       set_port_helper(binding);
     }
   } else {
-    for (auto n : p->triggers()) {
+    for (auto n : p->active_triggers()) {
       triggered_reactions[Worker::current_worker_id()].push_back(n);
     }
   }
 }
 
+void Scheduler::notify() {
+  std::lock_guard<std::mutex> lg(m_schedule);
+  cv_schedule.notify_one();
+}
+
+void Scheduler::notify_ingress() {
+  // Only acquire the mutex if the scheduler actually waits. The sequentially
+  // consistent accesses to waiting_for_events ensure that either the
+  // scheduler observes the pending events before waiting, or this method
+  // observes that the scheduler waits.
+  if (waiting_for_events.load()) {
+    notify();
+  }
+}
+
+void Scheduler::register_ingress(Ingress* ingress, bool polled) {
+  ingresses.push_back(ingress);
+  if (polled) {
+    polled_ingresses.push_back(ingress);
+  }
+}
+
+void Scheduler::unregister_ingress(Ingress* ingress) {
+  ingresses.erase(std::remove(ingresses.begin(), ingresses.end(), ingress),
+                  ingresses.end());
+  polled_ingresses.erase(std::remove(polled_ingresses.begin(),
+                                     polled_ingresses.end(), ingress),
+                         polled_ingresses.end());
+}
+
+void Scheduler::register_tag_hook(TagHook* hook) {
+  tag_hooks.push_back(hook);
+}
+
+void Scheduler::unregister_tag_hook(TagHook* hook) {
+  tag_hooks.erase(std::remove(tag_hooks.begin(), tag_hooks.end(), hook),
+                  tag_hooks.end());
+}
+
+bool Scheduler::ingress_pending() const {
+  for (auto ingress : ingresses) {
+    if (ingress->pending()) {
+      return true;
+    }
+  }
+  return false;
+}
+
+bool Scheduler::poll_until(std::unique_lock<std::mutex>& lock,
+                           const TimePoint& until) {
+  // Release the lock while spinning, so that other threads can schedule
+  // events. The event queue is only modified by this thread.
+  lock.unlock();
+  bool woken{false};
+  while (true) {
+    if (async_events_pending.load(std::memory_order_acquire) || _stop ||
+        _environment->mutations_pending() || ingress_pending()) {
+      woken = true;
+      break;
+    }
+    if (until != TimePoint::max() && get_physical_time() >= until) {
+      break;
+    }
+    std::this_thread::yield();
+  }
+  lock.lock();
+  return woken;
+}
+
+void Scheduler::drain_ingresses() {
+  unsigned drained{0};
+  for (auto ingress : ingresses) {
+    if (ingress->pending()) {
+      ingress->drain();
+      drained++;
+    }
+  }
+
+  if (drained > 0) {
+    if (trace_accepts(TraceEvent::IngressDrain)) {
+      tracepoint(reactor_cpp, ingress_drain, Worker::current_worker_id(),
+                 drained);
+    }
+    if constexpr (flight_recorder_enabled) {
+      flight_recorder().record(FlightEvent::IngressDrain, nullptr, TimePoint{},
+                               drained);
+    }
+  }
+}
+
+void Scheduler::trace_tag_advance(const Tag& tag) const {
+  if (trace_accepts(TraceEvent::TagAdvance)) {
+    tracepoint(reactor_cpp, tag_advance, tag);
+  }
+  if constexpr (flight_recorder_enabled) {
+    flight_recorder().record(FlightEvent::TagAdvance, nullptr,
+                             tag.time_point(), tag.micro_step());
+  }
+}
+
+void Scheduler::trace_sleep_starts(const TimePoint& until) const {
+  if (trace_accepts(TraceEvent::PhysicalTimeSleep)) {
+    tracepoint(reactor_cpp, physical_time_sleep_starts,
+               Worker::current_worker_id(), until);
+  }
+  if constexpr (flight_recorder_enabled) {
+    flight_recorder().record(FlightEvent::PhysicalTimeSleepStarts, nullptr,
+                             until);
+  }
+}
+
+void Scheduler::trace_sleep_finishes() const {
+  if (trace_accepts(TraceEvent::PhysicalTimeSleep)) {
+    tracepoint(reactor_cpp, physical_time_sleep_finishes,
+               Worker::current_worker_id());
+  }
+  if constexpr (flight_recorder_enabled) {
+    flight_recorder().record(FlightEvent::PhysicalTimeSleepFinishes, nullptr);
+  }
+}
+
+void Scheduler::remove_events(const std::set<BaseAction*>& actions) {
+  // this is only called in between two tags
+  collect_scheduled_events();
+  std::lock_guard<std::mutex> lg(m_schedule);
+  for (auto queue : {&event_queue, &async_event_queue}) {
+    for (auto it = queue->begin(); it != queue->end();) {
+      for (auto action : actions) {
+        it->second.erase(action);
+      }
+      if (it->second.empty()) {
+        it = queue->erase(it);
+      } else {
+        it++;
+      }
+    }
+  }
+}
+
+void Scheduler::register_mode_change(Reactor* reactor) {
+  // mode changes are buffered per worker like set ports
+  auto worker = Worker::current_worker;
+  reactor::validate(worker != nullptr && &worker->scheduler == this,
+           "Mode changes may only be registered by the workers of the "
+           "reactor's environment!");
+  mode_changes[worker->id].push_back(reactor);
+}
+
 void Scheduler::stop() {
   _stop = true;
   cv_schedule.notify_one();
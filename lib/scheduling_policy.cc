@@ -0,0 +1,144 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include "reactor-cpp/scheduling_policy.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "reactor-cpp/environment.hh"
+#include "reactor-cpp/reaction.hh"
+
+namespace reactor {
+
+void LevelPolicy::update(const Environment& environment) {
+  reaction_queue.resize(environment.max_reaction_index() + 1);
+}
+
+void LevelPolicy::trigger(Reaction* reaction) {
+  reaction_queue[reaction->index()].push_back(reaction);
+}
+
+bool LevelPolicy::next_ready(std::vector<Reaction*>& ready, unsigned& level) {
+  // continue iterating over the reaction queue
+  for (; reaction_queue_pos < reaction_queue.size(); reaction_queue_pos++) {
+    auto& reactions = reaction_queue[reaction_queue_pos];
+    if (!reactions.empty()) {
+      // Make sure that any reaction is only executed once even if it
+      // was triggered multiple times.
+      std::sort(reactions.begin(), reactions.end());
+      reactions.erase(std::unique(reactions.begin(), reactions.end()),
+                      reactions.end());
+      ready.swap(reactions);
+      level = reaction_queue_pos;
+      return true;
+    }
+  }
+
+  // start over at the next tag
+  reaction_queue_pos = 0;
+  return false;
+}
+
+void DependencyPolicy::update(const Environment& environment) {
+  const auto& dependencies = environment.reaction_dependencies();
+
+  // visit the reactions in topological order
+  std::vector<Reaction*> reactions;
+  reactions.reserve(dependencies.size());
+  for (const auto& entry : dependencies) {
+    reactions.push_back(entry.first);
+  }
+  std::sort(reactions.begin(), reactions.end(),
+            [](const Reaction* a, const Reaction* b) {
+              return a->index() < b->index();
+            });
+
+  ids.clear();
+  for (std::size_t i = 0; i < reactions.size(); i++) {
+    ids[reactions[i]] = i;
+  }
+
+  auto words = (reactions.size() + 63) / 64;
+  upstream.assign(reactions.size(), Bits(words, 0));
+  for (std::size_t i = 0; i < reactions.size(); i++) {
+    auto& bits = upstream[i];
+    for (auto d : dependencies.at(reactions[i])) {
+      auto id = ids.at(d);
+      const auto& transitive = upstream[id];
+      for (std::size_t w = 0; w < words; w++) {
+        bits[w] |= transitive[w];
+      }
+      bits[id / 64] |= std::uint64_t{1} << (id % 64);
+    }
+  }
+
+  assert(pending.empty());
+  pending_bits.assign(words, 0);
+}
+
+void DependencyPolicy::trigger(Reaction* reaction) {
+  auto it = ids.find(reaction);
+  assert(it != ids.end());
+  auto id = it->second;
+  auto& word = pending_bits[id / 64];
+  auto bit = std::uint64_t{1} << (id % 64);
+  if ((word & bit) == 0) {
+    word |= bit;
+    pending.emplace_back(reaction, id);
+  }
+}
+
+bool DependencyPolicy::next_ready(std::vector<Reaction*>& ready,
+                                  unsigned& level) {
+  if (pending.empty()) {
+    batch = 0;
+    return false;
+  }
+
+  // A reaction is ready if none of its transitive dependencies is pending.
+  // Since the dependency graph is acyclic, there is at least one.
+  auto words = pending_bits.size();
+  auto blocked = std::stable_partition(
+      pending.begin(), pending.end(), [this, words](const auto& entry) {
+        const auto& bits = upstream[entry.second];
+        for (std::size_t w = 0; w < words; w++) {
+          if ((bits[w] & pending_bits[w]) != 0) {
+            return false;
+          }
+        }
+        return true;
+      });
+  assert(blocked != pending.begin());
+
+  for (auto it = pending.begin(); it != blocked; it++) {
+    ready.push_back(it->first);
+    pending_bits[it->second / 64] &= ~(std::uint64_t{1} << (it->second % 64));
+  }
+  pending.erase(pending.begin(), blocked);
+
+  level = batch++;
+  return true;
+}
+
+bool SequentialPolicy::next_ready(std::vector<Reaction*>& ready,
+                                  unsigned& level) {
+  if (batch_pos == batch.size()) {
+    batch.clear();
+    batch_pos = 0;
+    if (!LevelPolicy::next_ready(batch, batch_level)) {
+      return false;
+    }
+  }
+
+  ready.push_back(batch[batch_pos++]);
+  level = batch_level;
+  return true;
+}
+
+}  // namespace reactor
@@ -0,0 +1,280 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include "reactor-cpp/shared_memory.hh"
+
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <system_error>
+#include <thread>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace reactor {
+
+namespace {
+
+constexpr std::uint64_t arena_magic{0x7265616374617200};  // "reactar"
+// Blocks are sized in powers of two, starting at 32 bytes
+constexpr std::size_t min_block_shift{5};
+constexpr std::size_t num_size_classes{40};
+constexpr std::size_t max_block_size{std::size_t{1}
+                                     << (num_size_classes - 1 +
+                                         min_block_shift)};
+
+static_assert(std::atomic<std::uint32_t>::is_always_lock_free,
+              "Shared memory arenas require address-free atomics");
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "Shared memory arenas require address-free atomics");
+
+}  // namespace
+
+// Lives at the beginning of the shared memory segment. All offsets are
+// relative to the segment start. An offset of 0 denotes no block, as the
+// header occupies the beginning of the segment.
+struct SharedMemoryArena::Header {
+  std::uint64_t magic{0};
+  std::uint64_t size{0};
+  std::atomic<std::uint32_t> spinlock{0};
+  // the fields below are protected by the spinlock
+  std::uint64_t top{0};
+  std::uint64_t free_lists[num_size_classes]{};
+  std::uint64_t slots[num_slots]{};
+};
+
+struct alignas(std::max_align_t) SharedMemoryArena::Block {
+  std::uint32_t size_class{0};
+  std::atomic<std::uint32_t> references{0};
+  // only valid while the block is in a free list
+  std::uint64_t next_free{0};
+};
+
+std::size_t SharedMemoryArena::header_size() {
+  constexpr std::size_t align = alignof(std::max_align_t);
+  return (sizeof(Header) + align - 1) / align * align;
+}
+
+namespace {
+
+std::system_error system_error(const std::string& what) {
+  return std::system_error(errno, std::generic_category(), what);
+}
+
+}  // namespace
+
+SharedMemoryArena::SharedMemoryArena(const std::string& name, std::size_t size)
+    : _name(name), _owner(true), _size(size) {
+  reactor::validate(size > header_size(),
+                    "The shared memory arena is too small");
+
+  int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) {
+    throw system_error("Cannot create shared memory arena " + name);
+  }
+  if (ftruncate(fd, static_cast<off_t>(size)) != 0) {
+    auto error = system_error("Cannot resize shared memory arena " + name);
+    close(fd);
+    shm_unlink(name.c_str());
+    throw error;
+  }
+  void* memory =
+      mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    auto error = system_error("Cannot map shared memory arena " + name);
+    shm_unlink(name.c_str());
+    throw error;
+  }
+
+  header = new (memory) Header();
+  header->size = size;
+  header->top = header_size();
+  // publish the header only after it is initialized
+  std::atomic_thread_fence(std::memory_order_release);
+  header->magic = arena_magic;
+}
+
+SharedMemoryArena::SharedMemoryArena(const std::string& name)
+    : _name(name), _owner(false) {
+  int fd = shm_open(name.c_str(), O_RDWR, 0600);
+  if (fd < 0) {
+    throw system_error("Cannot open shared memory arena " + name);
+  }
+  struct stat info {};
+  if (fstat(fd, &info) != 0) {
+    auto error = system_error("Cannot stat shared memory arena " + name);
+    close(fd);
+    throw error;
+  }
+  _size = static_cast<std::size_t>(info.st_size);
+  reactor::validate(_size > header_size(),
+                    "The shared memory arena " + name + " is not initialized");
+  void* memory =
+      mmap(nullptr, _size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  close(fd);
+  if (memory == MAP_FAILED) {
+    throw system_error("Cannot map shared memory arena " + name);
+  }
+
+  header = static_cast<Header*>(memory);
+  if (header->magic != arena_magic || header->size != _size) {
+    munmap(memory, _size);
+    throw ValidationError("The shared memory arena " + name +
+                          " is not initialized");
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+}
+
+SharedMemoryArena::~SharedMemoryArena() {
+  munmap(header, _size);
+  if (_owner) {
+    shm_unlink(_name.c_str());
+  }
+}
+
+void SharedMemoryArena::lock() const {
+  while (header->spinlock.exchange(1, std::memory_order_acquire) != 0) {
+    while (header->spinlock.load(std::memory_order_relaxed) != 0) {
+      std::this_thread::yield();
+    }
+  }
+}
+
+void SharedMemoryArena::unlock() const {
+  header->spinlock.store(0, std::memory_order_release);
+}
+
+SharedMemoryArena::Block* SharedMemoryArena::block_of(
+    const void* value) const {
+  assert(contains(value));
+  auto* address = static_cast<unsigned char*>(const_cast<void*>(value));
+  return reinterpret_cast<Block*>(address) - 1;
+}
+
+void* SharedMemoryArena::allocate(std::size_t size) {
+  // reject sizes beyond the largest size class before computing the class,
+  // which also avoids an overflow of size + sizeof(Block)
+  if (size > max_block_size - sizeof(Block)) {
+    throw std::bad_alloc();
+  }
+  std::size_t size_class = 0;
+  while ((std::size_t{1} << (size_class + min_block_shift)) <
+         size + sizeof(Block)) {
+    size_class++;
+  }
+  const std::size_t block_size = std::size_t{1}
+                                 << (size_class + min_block_shift);
+
+  lock();
+  std::uint64_t offset = header->free_lists[size_class];
+  if (offset != 0) {
+    header->free_lists[size_class] =
+        reinterpret_cast<Block*>(base() + offset)->next_free;
+  } else if (header->top + block_size <= _size) {
+    offset = header->top;
+    header->top += block_size;
+  }
+  unlock();
+
+  if (offset == 0) {
+    throw std::bad_alloc();
+  }
+
+  auto* block = new (base() + offset) Block();
+  block->size_class = static_cast<std::uint32_t>(size_class);
+  block->references.store(1, std::memory_order_relaxed);
+  return block + 1;
+}
+
+void SharedMemoryArena::retain(const void* value) {
+  block_of(value)->references.fetch_add(1, std::memory_order_relaxed);
+}
+
+void SharedMemoryArena::release(const void* value) {
+  Block* block = block_of(value);
+  if (block->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+    lock();
+    block->next_free = header->free_lists[block->size_class];
+    header->free_lists[block->size_class] =
+        reinterpret_cast<unsigned char*>(block) - base();
+    unlock();
+  }
+}
+
+bool SharedMemoryArena::contains(const void* value) const {
+  const auto* address = static_cast<const unsigned char*>(value);
+  return address >= base() + header_size() && address < base() + _size;
+}
+
+std::size_t SharedMemoryArena::offset_of(const void* value) const {
+  reactor::validate(contains(value),
+                    "The value is not allocated from this arena");
+  return static_cast<const unsigned char*>(value) - base();
+}
+
+const void* SharedMemoryArena::address_of(std::size_t offset) const {
+  reactor::validate(offset >= header_size() && offset < _size,
+                    "The offset is not within this arena");
+  return base() + offset;
+}
+
+void SharedMemoryArena::publish_value(std::size_t slot, const void* value) {
+  reactor::validate(slot < num_slots, "Invalid shared memory arena slot");
+  std::uint64_t offset = 0;
+  if (value != nullptr) {
+    offset = offset_of(value);
+    retain(value);
+  }
+
+  lock();
+  std::uint64_t previous = header->slots[slot];
+  header->slots[slot] = offset;
+  unlock();
+
+  // The reference held by the slot is dropped outside of the lock, as
+  // releasing the last reference needs to acquire the lock again.
+  if (previous != 0) {
+    release(base() + previous);
+  }
+}
+
+const void* SharedMemoryArena::observe_value(std::size_t slot,
+                                             std::size_t size) {
+  reactor::validate(slot < num_slots, "Invalid shared memory arena slot");
+  const void* value{nullptr};
+
+  // Retaining while holding the lock ensures that the value cannot be
+  // released by a concurrent publish in between reading the slot and
+  // taking the reference.
+  lock();
+  std::uint64_t offset = header->slots[slot];
+  if (offset != 0) {
+    value = base() + offset;
+    retain(value);
+  }
+  unlock();
+
+  if (value != nullptr) {
+    std::size_t block_size = std::size_t{1}
+                             << (block_of(value)->size_class + min_block_shift);
+    if (block_size - sizeof(Block) < size) {
+      release(value);
+      throw ValidationError(
+          "The value in the shared memory arena slot is smaller than the "
+          "requested type");
+    }
+  }
+
+  return value;
+}
+
+}  // namespace reactor
@@ -0,0 +1,132 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include "reactor-cpp/trace_filter.hh"
+
+#include "reactor-cpp/assert.hh"
+#include "reactor-cpp/reactor.hh"
+
+namespace reactor {
+
+TraceFilter& TraceFilter::instance() {
+  static TraceFilter filter{};
+  return filter;
+}
+
+bool TraceFilter::selects(const ReactorElement* element) const {
+  auto current = generation.load(std::memory_order_acquire);
+  auto cached =
+      element->_trace_filter_cache.value.load(std::memory_order_relaxed);
+  if ((cached >> 1) == current) {
+    return (cached & 1u) != 0;
+  }
+
+  auto sel = std::atomic_load(&selection);
+  bool selected = sel->subtrees.empty();
+  for (const auto& subtree : sel->subtrees) {
+    const auto& fqn = element->fqn();
+    if (fqn.compare(0, subtree.size(), subtree) == 0 &&
+        (fqn.size() == subtree.size() || fqn[subtree.size()] == '.')) {
+      selected = true;
+      break;
+    }
+  }
+  if (selected && !sel->pattern.empty()) {
+    selected = match(sel->pattern.c_str(), element->fqn().c_str());
+  }
+
+  // Another thread may have reconfigured the filter in the meantime. Storing
+  // the outdated generation is harmless, as the next check recomputes.
+  element->_trace_filter_cache.value.store(
+      (current << 1) | (selected ? 1u : 0u), std::memory_order_relaxed);
+  return selected;
+}
+
+bool TraceFilter::in_sample() const {
+  auto rate = sampling_rate.load(std::memory_order_relaxed);
+  if (rate > 1) {
+    thread_local std::uint32_t counter{0};
+    if (counter++ % rate != 0) {
+      return false;
+    }
+  }
+
+  auto period = window_period.load(std::memory_order_relaxed);
+  if (period > 0) {
+    auto now = get_physical_time().time_since_epoch().count();
+    if (now % period >= window_length.load(std::memory_order_relaxed)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+bool TraceFilter::match(const char* pattern, const char* name) {
+  // iterative glob matching with backtracking to the last `*`
+  const char* star{nullptr};
+  const char* resume{nullptr};
+  while (*name != '\0') {
+    if (*pattern == '*') {
+      star = pattern++;
+      resume = name;
+    } else if (*pattern == '?' || *pattern == *name) {
+      pattern++;
+      name++;
+    } else if (star != nullptr) {
+      pattern = star + 1;
+      name = ++resume;
+    } else {
+      return false;
+    }
+  }
+  while (*pattern == '*') {
+    pattern++;
+  }
+  return *pattern == '\0';
+}
+
+void TraceFilter::update_selection(
+    const std::function<void(Selection&)>& update) {
+  std::lock_guard<std::mutex> lock(mutex);
+  auto sel = std::make_shared<Selection>(*std::atomic_load(&selection));
+  update(*sel);
+  std::atomic_store(&selection,
+                    std::shared_ptr<const Selection>(std::move(sel)));
+  // skip the reserved generation 0 on wrap around
+  if (generation.fetch_add(1, std::memory_order_acq_rel) + 1 >
+      (~0u >> 1)) {
+    generation.store(1, std::memory_order_release);
+  }
+}
+
+void TraceFilter::add_subtree(const std::string& fqn) {
+  update_selection([&fqn](Selection& sel) { sel.subtrees.push_back(fqn); });
+}
+
+void TraceFilter::set_pattern(const std::string& pattern) {
+  update_selection([&pattern](Selection& sel) { sel.pattern = pattern; });
+}
+
+void TraceFilter::clear_selection() {
+  update_selection([](Selection& sel) { sel = Selection{}; });
+}
+
+void TraceFilter::set_sampling_rate(std::uint32_t n) {
+  reactor::validate(n > 0, "The trace sampling rate must be positive");
+  sampling_rate.store(n, std::memory_order_relaxed);
+}
+
+void TraceFilter::set_time_window(Duration period, Duration length) {
+  reactor::validate(period.count() >= 0 && length.count() >= 0,
+                    "The trace window must not be negative");
+  window_length.store(length.count(), std::memory_order_relaxed);
+  window_period.store(period.count(), std::memory_order_relaxed);
+}
+
+}  // namespace reactor
@@ -0,0 +1,10 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#define CATCH_CONFIG_MAIN
+#include <catch2/catch.hpp>
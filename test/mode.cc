@@ -0,0 +1,128 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "reactor-cpp/reactor-cpp.hh"
+
+using namespace reactor;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Switches from mode A to mode B in the third and back to A in the sixth
+// tick. Mode A contains a timer that only fires while A is active.
+class Switch : public Reactor {
+ public:
+  Mode a{"A", this};
+  Mode b{"B", this};
+  Timer tick{"tick", this, 1s};
+  Timer fast{"fast", this, 300ms, 100ms};
+  int ticks{0};
+  bool declare_change{true};
+  bool rejected{false};
+  std::vector<std::string> log{};
+
+  Reaction change{"change", 1, this, [this]() {
+                    ticks++;
+                    try {
+                      if (ticks == 3) {
+                        set_mode(&b);
+                      } else if (ticks == 6) {
+                        set_mode(&a);
+                      }
+                    } catch (const ValidationError&) {
+                      rejected = true;
+                    }
+                    if (ticks == 8) {
+                      environment()->sync_shutdown();
+                    }
+                  }};
+  Reaction in_a{"in_a", 2, this, [this]() { record("A"); }};
+  Reaction in_b{"in_b", 3, this, [this]() { record("B"); }};
+  Reaction timer_a{"timer_a", 4, this, [this]() { record("fast"); }};
+
+  void record(const std::string& what) {
+    log.push_back(std::to_string(get_elapsed_logical_time().count() /
+                                 100000000) +
+                  " " + what);
+  }
+
+  Switch(Environment* env, bool declare_change)
+      : Reactor("switch", env), declare_change(declare_change) {}
+
+  void assemble() override {
+    change.declare_trigger(&tick);
+    if (declare_change) {
+      change.declare_mode_change();
+    }
+    in_a.declare_trigger(&tick);
+    in_b.declare_trigger(&tick);
+    timer_a.declare_trigger(&fast);
+    a.declare_reaction(&in_a);
+    a.declare_reaction(&timer_a);
+    a.declare_timer(&fast);
+    b.declare_reaction(&in_b);
+  }
+};
+
+class Plain : public Reactor {
+ public:
+  Reaction r{"r", 1, this, []() {}};
+  Plain(Environment* env) : Reactor("plain", env) {}
+  void assemble() override {}
+};
+
+}  // namespace
+
+TEST_CASE("modes switch after the tag of the mode change",
+          "[mode][user-102]") {
+  Environment env{4, false, true};
+  Switch s{&env, true};
+  env.assemble();
+  env.startup().join();
+
+  // elapsed logical time in units of 100ms
+  std::vector<std::string> expected{
+      "0 A",  "1 fast",  "4 fast",  "7 fast",  "10 A",  "10 fast",
+      "13 fast", "16 fast", "19 fast", "20 A", "30 B", "40 B",
+      "50 B",  "51 fast", "54 fast", "57 fast", "60 A", "60 fast",
+      "63 fast", "66 fast", "69 fast", "70 A"};
+  CHECK(s.log == expected);
+  CHECK_FALSE(s.rejected);
+}
+
+TEST_CASE("only reactions that declared a mode change may set the mode",
+          "[mode][user-102]") {
+  Environment env{4, false, true};
+  Switch s{&env, false};
+  env.assemble();
+  env.startup().join();
+
+  CHECK(s.rejected);
+  for (const auto& entry : s.log) {
+    CHECK(entry.find('B') == std::string::npos);
+  }
+}
+
+TEST_CASE("mode changes are validated during assembly", "[mode][user-118]") {
+  Environment env{1};
+  Switch s{&env, true};
+  Plain p{&env};
+  env.assemble();
+
+  // pure reactions may not change modes, regardless of the order
+  CHECK_THROWS_AS(s.change.declare_pure(), ValidationError);
+  CHECK_NOTHROW(s.in_b.declare_pure());
+  CHECK_THROWS_AS(s.in_b.declare_mode_change(), ValidationError);
+  // only reactors with modes may change modes
+  CHECK_THROWS_AS(p.r.declare_mode_change(), ValidationError);
+}
@@ -0,0 +1,159 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "reactor-cpp/reactor-cpp.hh"
+
+using namespace reactor;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Sends the numbers 0 to 9 in consecutive tags and requests the given
+// mutations after sending 2 and 6.
+class Source : public Reactor {
+ public:
+  Timer timer{"timer", this, 1s};
+  Output<int> out{"out", this};
+  Output<int> unused{"unused", this};
+  int value{0};
+  std::function<void(void)> first_mutation{};
+  std::function<void(void)> second_mutation{};
+
+  Reaction send{"send", 1, this, [this]() {
+                  out.set(value++);
+                  if (value == 3 && first_mutation) {
+                    environment()->request_mutation(first_mutation);
+                  } else if (value == 7 && second_mutation) {
+                    environment()->request_mutation(second_mutation);
+                  } else if (value == 10) {
+                    environment()->sync_shutdown();
+                  }
+                }};
+  // a pure reaction whose effects are never observed
+  Reaction dead{"dead", 2, this, [this]() { unused.set(0); }};
+
+  Source(Environment* env) : Reactor("source", env) {}
+
+  void assemble() override {
+    send.declare_trigger(&timer);
+    send.declare_antidependency(&out);
+    dead.declare_trigger(&timer);
+    dead.declare_antidependency(&unused);
+    dead.declare_pure();
+  }
+};
+
+// Forwards its input. Unless the relay is pure, it also records all values
+// it received.
+class Relay : public Reactor {
+ public:
+  Input<int> in{"in", this};
+  Output<int> out{"out", this};
+  const bool pure;
+  std::vector<int> received{};
+
+  Reaction forward{"forward", 1, this, [this]() {
+                     if (!pure) {
+                       received.push_back(*in.get());
+                     }
+                     out.set(*in.get());
+                   }};
+
+  Relay(const std::string& name, Environment* env, bool pure = false)
+      : Reactor(name, env), pure(pure) {}
+
+  void assemble() override {
+    forward.declare_trigger(&in);
+    forward.declare_antidependency(&out);
+    if (pure) {
+      forward.declare_pure();
+    }
+  }
+};
+
+class Sink : public Reactor {
+ public:
+  Input<int> in{"in", this};
+  std::vector<int> received{};
+
+  Reaction receive{"receive", 1, this,
+                   [this]() { received.push_back(*in.get()); }};
+
+  Sink(const std::string& name, Environment* env) : Reactor(name, env) {}
+
+  void assemble() override { receive.declare_trigger(&in); }
+};
+
+}  // namespace
+
+TEST_CASE("mutations reindex added and remaining reactions",
+          "[mutation][user-101]") {
+  Environment env{4, false, true};
+  Source source{&env};
+  std::unique_ptr<Relay> first{};
+  std::unique_ptr<Relay> second{};
+
+  source.first_mutation = [&]() {
+    first = std::make_unique<Relay>("first", &env);
+    second = std::make_unique<Relay>("second", &env);
+    source.out.bind_to(&first->in);
+    first->out.bind_to(&second->in);
+  };
+  source.second_mutation = [&]() {
+    // bind the second relay directly to the source, bypassing the first one
+    first->out.unbind_from(&second->in);
+    source.out.bind_to(&second->in);
+    env.remove_reactor(first.get());
+  };
+
+  env.assemble();
+  env.startup().join();
+
+  REQUIRE(first != nullptr);
+  REQUIRE(second != nullptr);
+  CHECK(first->received == std::vector<int>{3, 4, 5, 6});
+  CHECK(second->received == std::vector<int>{3, 4, 5, 6, 7, 8, 9});
+  CHECK(second->forward.index() > source.send.index());
+}
+
+TEST_CASE("mutations restore pruned reactions that became observable",
+          "[mutation][user-118]") {
+  Environment env{4, false, true};
+  Source source{&env};
+  // connected to the source, but not observed until a sink is added
+  Relay first{"first", &env, true};
+  Relay second{"second", &env, true};
+  std::unique_ptr<Sink> sink{};
+
+  source.out.bind_to(&first.in);
+  first.out.bind_to(&second.in);
+  source.first_mutation = [&]() {
+    sink = std::make_unique<Sink>("sink", &env);
+    second.out.bind_to(&sink->in);
+  };
+
+  env.assemble();
+  env.startup().join();
+
+  REQUIRE(sink != nullptr);
+  CHECK(sink->received == std::vector<int>{3, 4, 5, 6, 7, 8, 9});
+  CHECK_FALSE(first.forward.is_pruned());
+  CHECK_FALSE(second.forward.is_pruned());
+  CHECK(first.forward.index() > source.send.index());
+  CHECK(second.forward.index() > first.forward.index());
+  CHECK(sink->receive.index() > second.forward.index());
+  // reactions that are still not observable remain pruned
+  CHECK(source.dead.is_pruned());
+}
@@ -0,0 +1,228 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <catch2/catch.hpp>
+
+#include "reactor-cpp/reactor-cpp.hh"
+
+using namespace reactor;
+using namespace std::chrono_literals;
+
+namespace {
+
+// Records the order in which reactions start and finish, and the number of
+// reactions that executed concurrently.
+class Recorder {
+ private:
+  std::mutex mutex;
+  std::uint64_t sequence{0};
+  unsigned running{0};
+
+ public:
+  // maps each tag and reaction to the sequence numbers of its start and end
+  std::map<std::pair<Duration, std::string>,
+           std::pair<std::uint64_t, std::uint64_t>>
+      executions{};
+  unsigned max_running{0};
+
+  void start(const Reactor* reactor, const std::string& name) {
+    std::lock_guard<std::mutex> lg(mutex);
+    auto key = std::make_pair(reactor->get_elapsed_logical_time(), name);
+    executions[key].first = sequence++;
+    running++;
+    max_running = std::max(max_running, running);
+  }
+
+  void finish(const Reactor* reactor, const std::string& name) {
+    std::lock_guard<std::mutex> lg(mutex);
+    auto key = std::make_pair(reactor->get_elapsed_logical_time(), name);
+    executions[key].second = sequence++;
+    running--;
+  }
+};
+
+// Executes a recorded reaction that takes a little while, so that reactions
+// that are executed concurrently overlap.
+template <class F>
+void execute(Recorder& recorder,
+             const Reactor* reactor,
+             const std::string& name,
+             F&& body) {
+  recorder.start(reactor, name);
+  std::this_thread::sleep_for(100us);
+  body();
+  recorder.finish(reactor, name);
+}
+
+class Source : public Reactor {
+ public:
+  Timer timer{"timer", this, 1ms};
+  Output<int> out{"out", this};
+  Recorder& recorder;
+  int count{0};
+
+  Reaction send{"send", 1, this, [this]() {
+                  execute(recorder, this, "source", [this]() {
+                    out.set(count);
+                    if (++count == 20) {
+                      environment()->sync_shutdown();
+                    }
+                  });
+                }};
+
+  Source(Environment* env, Recorder& recorder)
+      : Reactor("source", env), recorder(recorder) {}
+
+  void assemble() override {
+    send.declare_trigger(&timer);
+    send.declare_antidependency(&out);
+  }
+};
+
+class Relay : public Reactor {
+ public:
+  Input<int> in{"in", this};
+  Output<int> out{"out", this};
+  Recorder& recorder;
+
+  Reaction forward{"forward", 1, this, [this]() {
+                     execute(recorder, this, name(),
+                             [this]() { out.set(*in.get() + 1); });
+                   }};
+
+  Relay(const std::string& name, Environment* env, Recorder& recorder)
+      : Reactor(name, env), recorder(recorder) {}
+
+  void assemble() override {
+    forward.declare_trigger(&in);
+    forward.declare_antidependency(&out);
+  }
+};
+
+class Join : public Reactor {
+ public:
+  Input<int> left{"left", this};
+  Input<int> right{"right", this};
+  Recorder& recorder;
+
+  Reaction receive{"receive", 1, this,
+                   [this]() { execute(recorder, this, "join", []() {}); }};
+
+  Join(Environment* env, Recorder& recorder)
+      : Reactor("join", env), recorder(recorder) {}
+
+  void assemble() override {
+    receive.declare_trigger(&left);
+    receive.declare_trigger(&right);
+  }
+};
+
+// Three reactions that are ordered by their priorities.
+class Chain : public Reactor {
+ public:
+  Timer timer{"timer", this, 1ms};
+  Recorder& recorder;
+
+  Reaction first{"first", 1, this,
+                 [this]() { execute(recorder, this, "chain1", []() {}); }};
+  Reaction second{"second", 2, this,
+                  [this]() { execute(recorder, this, "chain2", []() {}); }};
+  Reaction third{"third", 3, this,
+                 [this]() { execute(recorder, this, "chain3", []() {}); }};
+
+  Chain(Environment* env, Recorder& recorder)
+      : Reactor("chain", env), recorder(recorder) {}
+
+  void assemble() override {
+    first.declare_trigger(&timer);
+    second.declare_trigger(&timer);
+    third.declare_trigger(&timer);
+  }
+};
+
+// Runs a diamond source -> {left, right -> right2} -> join next to an
+// independent chain of three reactions with the given policy.
+void run(std::unique_ptr<SchedulingPolicy> policy, Recorder& recorder) {
+  Environment env{4, false, true};
+  env.set_scheduling_policy(std::move(policy));
+  Source source{&env, recorder};
+  Relay left{"left", &env, recorder};
+  Relay right{"right", &env, recorder};
+  Relay right2{"right2", &env, recorder};
+  Join join{&env, recorder};
+  Chain chain{&env, recorder};
+
+  source.out.bind_to(&left.in);
+  source.out.bind_to(&right.in);
+  right.out.bind_to(&right2.in);
+  left.out.bind_to(&join.left);
+  right2.out.bind_to(&join.right);
+
+  env.assemble();
+  env.startup().join();
+}
+
+// Check that in each tag, each reaction started after all reactions it
+// depends on finished.
+void check_dependencies(const Recorder& recorder) {
+  const std::vector<std::pair<std::string, std::string>> dependencies{
+      {"source", "left"}, {"source", "right"}, {"right", "right2"},
+      {"left", "join"},   {"right2", "join"},  {"chain1", "chain2"},
+      {"chain2", "chain3"}};
+
+  std::map<Duration, unsigned> reactions_per_tag;
+  for (const auto& kv : recorder.executions) {
+    reactions_per_tag[kv.first.first]++;
+  }
+  REQUIRE(reactions_per_tag.size() == 20);
+
+  for (const auto& tag : reactions_per_tag) {
+    CHECK(tag.second == 8);
+    for (const auto& d : dependencies) {
+      const auto& before = recorder.executions.at({tag.first, d.first});
+      const auto& after = recorder.executions.at({tag.first, d.second});
+      CHECK(before.second < after.first);
+    }
+  }
+}
+
+}  // namespace
+
+TEST_CASE("the level policy respects dependencies",
+          "[scheduling_policy][user-122]") {
+  Recorder recorder;
+  run(std::make_unique<LevelPolicy>(), recorder);
+  check_dependencies(recorder);
+  CHECK(recorder.max_running > 1);
+}
+
+TEST_CASE("the dependency policy respects dependencies",
+          "[scheduling_policy][user-122]") {
+  Recorder recorder;
+  run(std::make_unique<DependencyPolicy>(), recorder);
+  check_dependencies(recorder);
+  CHECK(recorder.max_running > 1);
+}
+
+TEST_CASE("the sequential policy executes one reaction at a time",
+          "[scheduling_policy][user-122]") {
+  Recorder recorder;
+  run(std::make_unique<SequentialPolicy>(), recorder);
+  check_dependencies(recorder);
+  CHECK(recorder.max_running == 1);
+}
@@ -0,0 +1,72 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <string>
+#include <vector>
+
+#include <unistd.h>
+
+#include <catch2/catch.hpp>
+
+#include "reactor-cpp/shared_memory.hh"
+
+using namespace reactor;
+
+namespace {
+
+std::string arena_name(const std::string& test) {
+  return "/reactor-cpp-test-" + test + "-" + std::to_string(getpid());
+}
+
+}  // namespace
+
+TEST_CASE("arenas reject sizes beyond the largest block",
+          "[shared_memory][user-106]") {
+  SharedMemoryArena arena{arena_name("limits"), 1 << 20};
+
+  const auto max = std::numeric_limits<std::size_t>::max();
+  CHECK_THROWS_AS(arena.allocate(max), std::bad_alloc);
+  CHECK_THROWS_AS(arena.allocate(max - 8), std::bad_alloc);
+  CHECK_THROWS_AS(arena.allocate(std::size_t{1} << 63), std::bad_alloc);
+  CHECK_THROWS_AS(arena.allocate(std::size_t{1} << 50), std::bad_alloc);
+
+  // the arena remains usable after rejecting an allocation
+  void* value = arena.allocate(100);
+  CHECK(arena.contains(value));
+  arena.release(value);
+}
+
+TEST_CASE("arenas reject allocations once they are exhausted",
+          "[shared_memory][user-106]") {
+  SharedMemoryArena arena{arena_name("exhausted"), 1 << 16};
+
+  CHECK_THROWS_AS(arena.allocate(1 << 16), std::bad_alloc);
+
+  std::vector<void*> values;
+  bool exhausted{false};
+  while (!exhausted) {
+    try {
+      values.push_back(arena.allocate(1000));
+    } catch (const std::bad_alloc&) {
+      exhausted = true;
+    }
+  }
+  CHECK_FALSE(values.empty());
+  CHECK(values.size() < (1 << 16) / 1000);
+
+  // released blocks are reused
+  arena.release(values.back());
+  values.back() = arena.allocate(1000);
+  for (auto value : values) {
+    arena.release(value);
+  }
+}
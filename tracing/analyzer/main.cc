@@ -0,0 +1,764 @@
+/*
+ * Copyright (C) 2021 TU Dresden
+ * All rights reserved.
+ *
+ * Authors:
+ *   Christian Menard
+ */
+
+// Streams a json trace as produced by ctf_to_json.py or the flight recorder
+// and reports statistics about reaction executions, tags, workers and
+// actions. Events are processed one at a time in the order they appear in the
+// file, so that the memory required only depends on the size of the program
+// and not on the length of the trace.
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <queue>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace {
+
+/**
+ * A log-linear histogram of non-negative integer values.
+ *
+ * Each power of two is split into 16 buckets, which bounds the relative error
+ * of reported percentiles to about 6% while requiring at most 1000 buckets.
+ */
+class Histogram {
+ private:
+  static constexpr unsigned sub_bucket_bits{4};
+  static constexpr std::int64_t sub_buckets{1 << sub_bucket_bits};
+
+  std::vector<std::uint64_t> buckets{};
+  std::uint64_t _count{0};
+  double sum{0};
+  std::int64_t _max{0};
+
+  static std::size_t index_of(std::int64_t value) {
+    if (value < sub_buckets) {
+      return static_cast<std::size_t>(value);
+    }
+    // position of the most significant bit
+    unsigned exponent = 0;
+    for (auto v = static_cast<std::uint64_t>(value) >> 1; v != 0; v >>= 1) {
+      exponent++;
+    }
+    unsigned shift = exponent - sub_bucket_bits;
+    return static_cast<std::size_t>((shift + 1) * sub_buckets +
+                                    ((value >> shift) - sub_buckets));
+  }
+
+  static std::int64_t value_of(std::size_t index) {
+    auto i = static_cast<std::int64_t>(index);
+    if (i < sub_buckets) {
+      return i;
+    }
+    auto shift = i / sub_buckets - 1;
+    auto low = (sub_buckets + i % sub_buckets) << shift;
+    // report the middle of the bucket
+    return low + ((std::int64_t{1} << shift) >> 1);
+  }
+
+ public:
+  void add(std::int64_t value) {
+    value = std::max(value, std::int64_t{0});
+    auto index = index_of(value);
+    if (index >= buckets.size()) {
+      buckets.resize(index + 1, 0);
+    }
+    buckets[index]++;
+    _count++;
+    sum += static_cast<double>(value);
+    _max = std::max(_max, value);
+  }
+
+  std::uint64_t count() const { return _count; }
+  std::int64_t max() const { return _max; }
+  double mean() const {
+    return _count == 0 ? 0.0 : sum / static_cast<double>(_count);
+  }
+
+  std::int64_t percentile(double p) const {
+    auto rank = static_cast<std::uint64_t>(p / 100.0 * _count);
+    std::uint64_t seen{0};
+    for (std::size_t i = 0; i < buckets.size(); i++) {
+      seen += buckets[i];
+      if (seen > rank) {
+        return std::min(value_of(i), _max);
+      }
+    }
+    return _max;
+  }
+};
+
+/// The fields of a trace event that are relevant for the analysis
+struct Event {
+  std::string name{};
+  std::string cat{};
+  char ph{0};
+  // timestamps are converted from microseconds to nanoseconds
+  std::int64_t ts{0};
+  long pid{-1};
+  long tid{-1};
+  std::uint64_t microstep{0};
+  std::int64_t timestamp_ns{0};
+  std::string arg_name{};
+};
+
+/**
+ * A minimal streaming json parser that hands out the elements of the
+ * `traceEvents` array one at a time.
+ */
+class TraceReader {
+ private:
+  std::streambuf* buf;
+  bool in_events{false};
+
+  int peek() { return buf->sgetc(); }
+  int get() { return buf->sbumpc(); }
+
+  [[noreturn]] static void error(const std::string& msg) {
+    throw std::runtime_error("malformed trace: " + msg);
+  }
+
+  void skip_whitespace() {
+    while (peek() == ' ' || peek() == '\n' || peek() == '\r' ||
+           peek() == '\t') {
+      get();
+    }
+  }
+
+  void expect(char c) {
+    skip_whitespace();
+    if (get() != c) {
+      error(std::string("expected '") + c + "'");
+    }
+  }
+
+  std::string parse_string() {
+    expect('"');
+    std::string result;
+    for (int c = get(); c != '"'; c = get()) {
+      if (c == std::char_traits<char>::eof()) {
+        error("unterminated string");
+      }
+      if (c == '\\') {
+        c = get();
+        switch (c) {
+          case 'n':
+            c = '\n';
+            break;
+          case 't':
+            c = '\t';
+            break;
+          case 'u':
+            // names are ascii, replace other characters
+            for (int i = 0; i < 4; i++) {
+              get();
+            }
+            c = '?';
+            break;
+          default:
+            break;
+        }
+      }
+      result += static_cast<char>(c);
+    }
+    return result;
+  }
+
+  /// Returns numbers, true, false and null as their literal text
+  std::string parse_literal() {
+    skip_whitespace();
+    std::string result;
+    while (peek() != ',' && peek() != '}' && peek() != ']' && peek() != ' ' &&
+           peek() != '\n' && peek() != '\r' && peek() != '\t' &&
+           peek() != std::char_traits<char>::eof()) {
+      result += static_cast<char>(get());
+    }
+    if (result.empty()) {
+      error("expected a value");
+    }
+    return result;
+  }
+
+  void skip_value() {
+    skip_whitespace();
+    int c = peek();
+    if (c == '"') {
+      parse_string();
+    } else if (c == '{' || c == '[') {
+      char close = c == '{' ? '}' : ']';
+      get();
+      skip_whitespace();
+      if (peek() == close) {
+        get();
+        return;
+      }
+      do {
+        if (close == '}') {
+          parse_string();
+          expect(':');
+        }
+        skip_value();
+        skip_whitespace();
+      } while (get() == ',');
+    } else {
+      parse_literal();
+    }
+  }
+
+  // Timestamps are given in microseconds with up to nanosecond
+  // resolution. They are converted without going through a double, which
+  // would lose precision for absolute timestamps.
+  static std::int64_t to_nanoseconds(const std::string& us) {
+    if (us.find_first_of("eE") != std::string::npos) {
+      return static_cast<std::int64_t>(std::stod(us) * 1000.0);
+    }
+    auto dot = us.find('.');
+    std::int64_t ns = std::stoll(us.substr(0, dot)) * 1000;
+    if (dot != std::string::npos) {
+      std::string fraction = us.substr(dot + 1, 3);
+      fraction.resize(3, '0');
+      ns += (us[0] == '-' ? -1 : 1) * std::stoll(fraction);
+    }
+    return ns;
+  }
+
+  void parse_args(Event& event) {
+    expect('{');
+    skip_whitespace();
+    if (peek() == '}') {
+      get();
+      return;
+    }
+    do {
+      auto key = parse_string();
+      expect(':');
+      if (key == "microstep") {
+        event.microstep = std::stoull(parse_literal());
+      } else if (key == "timestamp_ns") {
+        event.timestamp_ns = std::stoll(parse_literal());
+      } else if (key == "name") {
+        event.arg_name = parse_string();
+      } else {
+        skip_value();
+      }
+      skip_whitespace();
+    } while (get() == ',');
+  }
+
+  void parse_event(Event& event) {
+    event = Event{};
+    expect('{');
+    skip_whitespace();
+    if (peek() == '}') {
+      get();
+      return;
+    }
+    do {
+      auto key = parse_string();
+      expect(':');
+      if (key == "name") {
+        event.name = parse_string();
+      } else if (key == "cat") {
+        event.cat = parse_string();
+      } else if (key == "ph") {
+        auto ph = parse_string();
+        event.ph = ph.empty() ? 0 : ph[0];
+      } else if (key == "ts") {
+        event.ts = to_nanoseconds(parse_literal());
+      } else if (key == "pid") {
+        event.pid = std::stol(parse_literal());
+      } else if (key == "tid") {
+        event.tid = std::stol(parse_literal());
+      } else if (key == "args") {
+        parse_args(event);
+      } else {
+        skip_value();
+      }
+      skip_whitespace();
+    } while (get() == ',');
+  }
+
+ public:
+  explicit TraceReader(std::streambuf* buf)
+      : buf(buf) {}
+
+  /// Read the next event. Returns false at the end of the events.
+  bool next(Event& event) {
+    if (!in_events) {
+      // find the events array in the top-level object
+      expect('{');
+      while (true) {
+        auto key = parse_string();
+        expect(':');
+        if (key == "traceEvents") {
+          break;
+        }
+        skip_value();
+        expect(',');
+      }
+      expect('[');
+      in_events = true;
+      skip_whitespace();
+      if (peek() == ']') {
+        get();
+        buf = nullptr;
+        return false;
+      }
+    } else {
+      if (buf == nullptr) {
+        return false;
+      }
+      skip_whitespace();
+      if (get() != ',') {
+        buf = nullptr;
+        return false;
+      }
+    }
+    parse_event(event);
+    return true;
+  }
+};
+
+struct ReactionStats {
+  Histogram execution{};
+  // number of tags where this reaction is on the critical path
+  std::uint64_t critical{0};
+};
+
+struct WorkerStats {
+  std::string reaction{};
+  std::int64_t start{-1};
+  unsigned level{0};
+  std::int64_t last_end{-1};
+  std::uint64_t executions{0};
+  std::int64_t busy{0};
+  Histogram gaps{};
+  std::int64_t parked{0};
+  std::int64_t park_start{-1};
+  std::int64_t sleeping{0};
+  std::int64_t sleep_start{-1};
+};
+
+using Tag = std::pair<std::int64_t, std::uint64_t>;
+using ElementId = std::pair<long, long>;
+
+struct SlowTag {
+  std::int64_t makespan;
+  Tag tag;
+  std::vector<std::pair<std::string, std::int64_t>> critical_path;
+
+  bool operator>(const SlowTag& other) const {
+    return makespan > other.makespan;
+  }
+};
+
+class Analyzer {
+ private:
+  // upper bound on the number of scheduled but not yet processed tags that
+  // are remembered for computing action delays
+  static constexpr std::size_t max_pending_tags{1 << 16};
+
+  std::size_t top_k;
+
+  std::unordered_map<std::string, ReactionStats> reactions{};
+  std::map<long, WorkerStats> workers{};
+  std::map<ElementId, Histogram> action_delays{};
+  std::map<Tag, std::vector<ElementId>> pending_actions{};
+
+  // names of reactors (processes) and their elements (threads)
+  std::map<long, std::string> processes{};
+  std::map<ElementId, std::string> threads{};
+
+  // state of the tag currently processed
+  bool tag_active{false};
+  Tag tag{};
+  std::int64_t tag_start{-1};
+  std::int64_t tag_end{-1};
+  bool tag_executed{false};
+  std::int64_t tag_first_execution{-1};
+  std::vector<ElementId> tag_actions{};
+  // longest reaction executed in each level
+  std::map<unsigned, std::pair<std::string, std::int64_t>> longest{};
+  unsigned level{0};
+
+  Histogram makespans{};
+  Histogram critical_paths{};
+  std::uint64_t ingress_drains{0};
+  std::priority_queue<SlowTag, std::vector<SlowTag>, std::greater<SlowTag>>
+      slowest{};
+
+  void begin_tag(const Tag& next, std::int64_t start) {
+    finish_tag();
+    tag_active = true;
+    tag = next;
+    tag_start = start;
+    tag_end = -1;
+    tag_executed = false;
+    level = 0;
+
+    // collect the actions that were scheduled for this tag and forget those
+    // scheduled for earlier tags that were never processed
+    auto it = pending_actions.begin();
+    while (it != pending_actions.end() && it->first <= tag) {
+      if (it->first == tag) {
+        tag_actions = std::move(it->second);
+      }
+      it = pending_actions.erase(it);
+    }
+  }
+
+  void finish_tag() {
+    if (!tag_active) {
+      return;
+    }
+    tag_active = false;
+    tag_actions.clear();
+    if (longest.empty()) {
+      return;
+    }
+
+    // The critical path is approximated by the chain of the longest reaction
+    // in each level. This is exact if levels are separated by barriers, but
+    // overestimates the path for scheduling policies that start a reaction as
+    // soon as its own dependencies completed.
+    SlowTag slow{tag_end - tag_start, tag, {}};
+    std::int64_t length{0};
+    for (auto& kv : longest) {
+      length += kv.second.second;
+      reactions[kv.second.first].critical++;
+      slow.critical_path.emplace_back(std::move(kv.second));
+    }
+    longest.clear();
+    critical_paths.add(length);
+
+    if (tag_start < 0 || tag_end < 0) {
+      return;
+    }
+    makespans.add(slow.makespan);
+    if (top_k > 0 &&
+        (slowest.size() < top_k || slowest.top().makespan < slow.makespan)) {
+      slowest.push(std::move(slow));
+      if (slowest.size() > top_k) {
+        slowest.pop();
+      }
+    }
+  }
+
+  void execution_starts(const Event& e) {
+    auto& worker = workers[e.tid];
+    if (worker.last_end >= 0) {
+      worker.gaps.add(e.ts - worker.last_end);
+    }
+    worker.reaction = e.name;
+    worker.start = e.ts;
+    worker.level = level;
+
+    if (tag_active && !tag_executed) {
+      tag_executed = true;
+      tag_first_execution = e.ts;
+      if (tag_start < 0) {
+        tag_start = e.ts;
+      }
+      for (const auto& action : tag_actions) {
+        action_delays[action].add(e.ts - tag.first);
+      }
+    }
+  }
+
+  void execution_finishes(const Event& e) {
+    auto& worker = workers[e.tid];
+    if (worker.start < 0 || worker.reaction != e.name) {
+      // the start was not recorded
+      return;
+    }
+    auto duration = e.ts - worker.start;
+    reactions[e.name].execution.add(duration);
+    worker.executions++;
+    worker.busy += duration;
+    worker.last_end = e.ts;
+    worker.start = -1;
+
+    if (tag_active) {
+      tag_end = std::max(tag_end, e.ts);
+      auto& entry = longest[worker.level];
+      if (entry.first.empty() || entry.second < duration) {
+        entry = std::make_pair(e.name, duration);
+      }
+    }
+  }
+
+  void scheduler_event(const Event& e) {
+    if (e.name == "tag advance") {
+      begin_tag(Tag{e.timestamp_ns, e.microstep}, e.ts);
+    } else if (e.name.compare(0, 6, "level ") == 0) {
+      if (e.ph == 'B') {
+        level = static_cast<unsigned>(std::stoul(e.name.substr(6)));
+      }
+    } else if (e.name == "parked") {
+      auto& worker = workers[e.tid];
+      if (e.ph == 'B') {
+        // idle gaps only cover the time a worker is neither parked nor
+        // sleeping
+        worker.last_end = -1;
+        worker.park_start = e.ts;
+      } else if (worker.park_start >= 0) {
+        worker.parked += e.ts - worker.park_start;
+        worker.park_start = -1;
+      }
+    } else if (e.name == "sleep") {
+      auto& worker = workers[e.tid];
+      if (e.ph == 'B') {
+        worker.last_end = -1;
+        worker.sleep_start = e.ts;
+      } else if (worker.sleep_start >= 0) {
+        worker.sleeping += e.ts - worker.sleep_start;
+        worker.sleep_start = -1;
+      }
+    } else if (e.name == "ingress drain") {
+      ingress_drains++;
+    }
+  }
+
+  void reactor_event(const Event& e) {
+    // Prefer the exact tag time given in the arguments over the timestamp,
+    // which is rounded in traces converted by ctf_to_json.py.
+    Tag event_tag{e.timestamp_ns != 0 ? e.timestamp_ns : e.ts, e.microstep};
+    if (e.name == "schedule") {
+      // Actions scheduled from outside of the scheduler (e.g. physical
+      // actions) might be recorded after the scheduler advanced to their tag.
+      if (tag_active && event_tag == tag) {
+        if (tag_executed) {
+          action_delays[ElementId(e.pid, e.tid)].add(tag_first_execution -
+                                                     tag.first);
+        } else {
+          tag_actions.emplace_back(e.pid, e.tid);
+        }
+        return;
+      }
+      if (tag_active && event_tag < tag) {
+        return;
+      }
+      auto& actions = pending_actions[event_tag];
+      if (std::find(actions.begin(), actions.end(), ElementId(e.pid, e.tid)) ==
+          actions.end()) {
+        actions.emplace_back(e.pid, e.tid);
+      }
+      if (pending_actions.size() > max_pending_tags) {
+        pending_actions.erase(std::prev(pending_actions.end()));
+      }
+    } else if (e.name == "trigger") {
+      // Traces without tag advance events are split into tags at the
+      // first trigger of each tag.
+      if (!tag_active || event_tag != tag) {
+        begin_tag(event_tag, -1);
+      }
+    }
+  }
+
+  std::string element_name(const ElementId& id) const {
+    auto process = processes.find(id.first);
+    auto thread = threads.find(id);
+    if (process == processes.end() || thread == threads.end()) {
+      return "<" + std::to_string(id.first) + ":" + std::to_string(id.second) +
+             ">";
+    }
+    return process->second + "." + thread->second;
+  }
+
+ public:
+  explicit Analyzer(std::size_t top_k)
+      : top_k(top_k) {}
+
+  void process(const Event& e) {
+    if (e.ph == 'M') {
+      if (e.name == "process_name") {
+        processes[e.pid] = e.arg_name;
+      } else if (e.name == "thread_name") {
+        threads[ElementId(e.pid, e.tid)] = e.arg_name;
+      }
+    } else if (e.cat == "Execution") {
+      if (e.ph == 'B') {
+        execution_starts(e);
+      } else if (e.ph == 'E') {
+        execution_finishes(e);
+      }
+    } else if (e.cat == "Scheduler") {
+      scheduler_event(e);
+    } else if (e.cat == "Reactors") {
+      reactor_event(e);
+    }
+  }
+
+  void report(std::ostream& out);
+};
+
+std::string us(std::int64_t ns) {
+  std::ostringstream str;
+  str << std::fixed << std::setprecision(1) << static_cast<double>(ns) / 1000.0;
+  return str.str();
+}
+
+std::ostream& print_histogram(std::ostream& out, const Histogram& h) {
+  return out << std::setw(10) << us(static_cast<std::int64_t>(h.mean()))
+             << std::setw(10) << us(h.percentile(50)) << std::setw(10)
+             << us(h.percentile(90)) << std::setw(10) << us(h.percentile(99))
+             << std::setw(10) << us(h.max());
+}
+
+const char* histogram_header() {
+  return "  mean[us]   p50[us]   p90[us]   p99[us]   max[us]";
+}
+
+void Analyzer::report(std::ostream& out) {
+  finish_tag();
+
+  std::vector<std::pair<std::string, const ReactionStats*>> sorted;
+  std::size_t width{13};
+  for (const auto& kv : reactions) {
+    sorted.emplace_back(kv.first, &kv.second);
+    width = std::max(width, kv.first.size());
+  }
+  for (const auto& kv : action_delays) {
+    width = std::max(width, element_name(kv.first).size());
+  }
+  std::sort(sorted.begin(), sorted.end());
+  width += 2;
+
+  out << "Reaction executions\n";
+  out << std::left << std::setw(width) << "reaction" << std::right
+      << std::setw(10) << "count" << histogram_header() << std::setw(10)
+      << "critical" << '\n';
+  for (const auto& kv : sorted) {
+    out << std::left << std::setw(width) << kv.first << std::right
+        << std::setw(10) << kv.second->execution.count();
+    print_histogram(out, kv.second->execution)
+        << std::setw(10) << kv.second->critical << '\n';
+  }
+
+  out << "\nTags\n";
+  out << std::left << std::setw(width) << "" << std::right << std::setw(10)
+      << "count" << histogram_header() << '\n';
+  out << std::left << std::setw(width) << "makespan" << std::right
+      << std::setw(10) << makespans.count();
+  print_histogram(out, makespans) << '\n';
+  out << std::left << std::setw(width) << "critical path*" << std::right
+      << std::setw(10) << critical_paths.count();
+  print_histogram(out, critical_paths) << '\n';
+  out << "* approximated as the sum of the longest reaction of each level\n";
+
+  std::vector<SlowTag> slow;
+  while (!slowest.empty()) {
+    slow.push_back(slowest.top());
+    slowest.pop();
+  }
+  if (!slow.empty()) {
+    out << "\nSlowest tags\n";
+  }
+  for (auto it = slow.rbegin(); it != slow.rend(); ++it) {
+    out << "[" << it->tag.first << " ns, " << it->tag.second
+        << "]: " << us(it->makespan) << " us, critical path*:";
+    for (const auto& reaction : it->critical_path) {
+      out << ' ' << reaction.first << " (" << us(reaction.second) << " us)";
+    }
+    out << '\n';
+  }
+
+  out << "\nWorkers\n";
+  out << std::left << std::setw(width) << "worker" << std::right
+      << std::setw(10) << "count" << std::setw(12) << "busy[ms]"
+      << std::setw(12) << "parked[ms]" << std::setw(12) << "sleep[ms]"
+      << "  idle gaps:" << histogram_header() << '\n';
+  for (const auto& kv : workers) {
+    const auto& w = kv.second;
+    out << std::left << std::setw(width) << kv.first << std::right
+        << std::setw(10) << w.executions << std::fixed << std::setprecision(3)
+        << std::setw(12) << static_cast<double>(w.busy) / 1e6 << std::setw(12)
+        << static_cast<double>(w.parked) / 1e6 << std::setw(12)
+        << static_cast<double>(w.sleeping) / 1e6 << std::setw(12) << "";
+    print_histogram(out, w.gaps) << '\n';
+  }
+
+  out << "\nDelay from the tag of an action to the first reaction execution";
+  if (ingress_drains > 0) {
+    out << " (" << ingress_drains << " ingress drains)";
+  }
+  out << '\n';
+  out << std::left << std::setw(width) << "action" << std::right
+      << std::setw(10) << "count" << histogram_header() << '\n';
+  for (const auto& kv : action_delays) {
+    out << std::left << std::setw(width) << element_name(kv.first) << std::right
+        << std::setw(10) << kv.second.count();
+    print_histogram(out, kv.second) << '\n';
+  }
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  std::size_t top_k{10};
+
+  const char* path{nullptr};
+  bool valid{true};
+  for (int i = 1; i < argc && valid; i++) {
+    std::string arg{argv[i]};
+    if (arg.compare(0, 2, "-k") == 0) {
+      // accept both "-k N" and "-kN"
+      std::string value = arg.size() > 2 ? arg.substr(2) : std::string{};
+      if (value.empty() && i + 1 < argc) {
+        value = argv[++i];
+      }
+      char* end{nullptr};
+      top_k = std::strtoul(value.c_str(), &end, 10);
+      valid = !value.empty() && *end == '\0';
+    } else if (arg.size() > 1 && arg[0] == '-') {
+      valid = false;
+    } else if (path == nullptr) {
+      path = argv[i];
+    } else {
+      valid = false;
+    }
+  }
+  if (!valid || path == nullptr) {
+    std::cerr << "usage: " << argv[0] << " [-k slowest_tags] TRACE"
+              << std::endl;
+    return 1;
+  }
+
+  std::ifstream file;
+  std::vector<char> buffer(1 << 20);
+  file.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+  file.open(path, std::ios::binary);
+  if (!file) {
+    std::cerr << "cannot open " << path << std::endl;
+    return 1;
+  }
+
+  Analyzer analyzer{top_k};
+  TraceReader reader{file.rdbuf()};
+  Event event;
+  try {
+    while (reader.next(event)) {
+      analyzer.process(event);
+    }
+  } catch (const std::exception& e) {
+    std::cerr << path << ": " << e.what() << std::endl;
+    return 1;
+  }
+
+  analyzer.report(std::cout);
+  return 0;
+}
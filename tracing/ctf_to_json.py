@@ -89,6 +89,22 @@ def main():
                 trace_events.append(schedule_action_to_dict(msg))
             elif (event.name == "reactor_cpp:trigger_reaction"):
                 trace_events.append(trigger_reaction_to_dict(msg))
+            elif (event.name == "reactor_cpp:tag_advance"):
+                trace_events.append(tag_advance_to_dict(msg))
+            elif (event.name == "reactor_cpp:level_starts"):
+                trace_events.append(level_to_dict(msg, "B"))
+            elif (event.name == "reactor_cpp:level_finishes"):
+                trace_events.append(level_to_dict(msg, "E"))
+            elif (event.name == "reactor_cpp:physical_time_sleep_starts"):
+                trace_events.append(scheduler_span_to_dict(msg, "sleep", "B"))
+            elif (event.name == "reactor_cpp:physical_time_sleep_finishes"):
+                trace_events.append(scheduler_span_to_dict(msg, "sleep", "E"))
+            elif (event.name == "reactor_cpp:worker_parks"):
+                trace_events.append(scheduler_span_to_dict(msg, "parked", "B"))
+            elif (event.name == "reactor_cpp:worker_unparks"):
+                trace_events.append(scheduler_span_to_dict(msg, "parked", "E"))
+            elif (event.name == "reactor_cpp:ingress_drain"):
+                trace_events.append(ingress_drain_to_dict(msg))
 
     # add some metadata
     configure_process_name(trace_events, 0, "Execution")
@@ -172,6 +188,7 @@ def schedule_action_to_dict(msg):
         "s": "t",
         "cname": "terrible",
         "args": {
+            "timestamp_ns": int(event["timestamp_ns"]),
             "microstep": int(event["timestamp_microstep"])
         }
     }
@@ -190,10 +207,70 @@ def trigger_reaction_to_dict(msg):
         "s": "t",
         "cname": "light_memory_dump",
         "args": {
+            "timestamp_ns": int(event["timestamp_ns"]),
             "microstep": int(event["timestamp_microstep"])
         }
     }
 
 
+def tag_advance_to_dict(msg):
+    event = msg.event
+    return {
+        "name": "tag advance",
+        "cat": "Scheduler",
+        "ph": "i",
+        "ts": get_timestamp_us(msg),
+        "pid": 0,
+        "s": "p",
+        "args": {
+            "timestamp_ns": int(event["timestamp_ns"]),
+            "microstep": int(event["timestamp_microstep"])
+        }
+    }
+
+
+def level_to_dict(msg, phase):
+    event = msg.event
+    return {
+        "name": "level %d" % int(event["level"]),
+        "cat": "Scheduler",
+        "ph": phase,
+        "ts": get_timestamp_us(msg),
+        "pid": 0,
+        "tid": int(event["worker_id"]),
+        "args": {
+            "width": int(event["width"])
+        }
+    }
+
+
+def scheduler_span_to_dict(msg, name, phase):
+    event = msg.event
+    return {
+        "name": name,
+        "cat": "Scheduler",
+        "ph": phase,
+        "ts": get_timestamp_us(msg),
+        "pid": 0,
+        "tid": int(event["worker_id"]),
+    }
+
+
+def ingress_drain_to_dict(msg):
+    event = msg.event
+    return {
+        "name": "ingress drain",
+        "cat": "Scheduler",
+        "ph": "i",
+        "ts": get_timestamp_us(msg),
+        "pid": 0,
+        "tid": int(event["worker_id"]),
+        "s": "t",
+        "args": {
+            "num_ingresses": int(event["num_ingresses"])
+        }
+    }
+
+
 if(__name__ == "__main__"):
     main()
@@ -0,0 +1,288 @@
+#!/usr/bin/env python3
+
+# Copyright (C) 2021 TU Dresden
+# All rights reserved.
+#
+# Authors:
+#   Christian Menard
+
+
+import argparse
+import bisect
+import heapq
+import json
+import re
+import statistics
+import sys
+
+
+def main():
+    parser = argparse.ArgumentParser(
+        description="Predict the performance of a reactor program for "
+                    "different numbers of workers and scheduling policies "
+                    "by replaying a recorded trace")
+    parser.add_argument("trace", metavar="TRACE", type=str,
+                        help="json trace as produced by ctf_to_json.py or "
+                             "the flight recorder")
+    parser.add_argument("graph", metavar="GRAPH", type=str,
+                        help="dependency graph as written by "
+                             "Environment::export_dependency_graph()")
+    parser.add_argument("-w", "--workers", metavar="N", type=int, nargs="+",
+                        default=[1, 2, 4, 8, 16, 64],
+                        help="worker counts to simulate")
+    parser.add_argument("-p", "--policy", choices=["level", "dag", "all"],
+                        default="all",
+                        help="scheduling policy to simulate: level barriers "
+                             "as implemented by the scheduler, or dependency "
+                             "driven execution without barriers")
+    parser.add_argument("--level-overhead", metavar="US", type=float,
+                        default=0.0,
+                        help="scheduler overhead per level in microseconds")
+    parser.add_argument("--reaction-overhead", metavar="US", type=float,
+                        default=0.0,
+                        help="scheduler overhead per reaction in "
+                             "microseconds")
+    args = parser.parse_args()
+
+    graph = DependencyGraph(args.graph)
+    tags = load_trace(args.trace, graph)
+    if not tags:
+        sys.exit("The trace does not contain any triggered reactions. Make "
+                 "sure that trigger_reaction and reaction execution events "
+                 "are recorded.")
+
+    policies = ["level", "dag"] if args.policy == "all" else [args.policy]
+    print("%d tags, %d reaction executions" %
+          (len(tags), sum(len(t.reactions) for t in tags)))
+    print("%-6s %7s %12s %12s %12s %12s %8s" %
+          ("policy", "workers", "mean [us]", "p99 [us]", "lag max [us]",
+           "tags/s", "speedup"))
+    for policy in policies:
+        baseline = None
+        for workers in args.workers:
+            result = simulate(tags, graph, workers, policy,
+                              args.level_overhead, args.reaction_overhead)
+            if baseline is None:
+                baseline = result.total
+            print("%-6s %7d %12.1f %12.1f %12.1f %12.1f %8.2f" %
+                  (policy, workers, result.mean, result.p99, result.max_lag,
+                   result.throughput, baseline / result.total
+                   if result.total > 0 else float("inf")))
+
+
+class DependencyGraph:
+    """The reaction graph as exported by reactor-cpp in the dot format."""
+
+    # Nodes and edges may be annotated with profiling results. The label of
+    # an annotated node starts with the fqn, followed by an escaped newline.
+    # Invisible edges only order the subgraphs and are ignored.
+    node_re = re.compile(r'^(\w+) \[label="([^"\\]*)(?:\\n[^"]*)?"'
+                         r'(?:, [^\]]*)?\];$')
+    edge_re = re.compile(r'^(\w+) -> (\w+)(?: \[label="\d+"[^\]]*\])?$')
+
+    def __init__(self, path):
+        # maps fqn to index
+        self.index = {}
+        # maps fqn to the set of fqns it depends on
+        self.dependencies = {}
+        names = {}
+        level = -1
+        with open(path) as dot:
+            for line in dot:
+                line = line.strip()
+                if line == "subgraph {":
+                    level += 1
+                    continue
+                match = self.node_re.match(line)
+                if match:
+                    names[match.group(1)] = match.group(2)
+                    self.index[match.group(2)] = level
+                    self.dependencies.setdefault(match.group(2), set())
+                    continue
+                match = self.edge_re.match(line)
+                if match:
+                    source = names[match.group(1)]
+                    target = names[match.group(2)]
+                    self.dependencies[source].add(target)
+
+
+class TagExecution:
+    def __init__(self, time_us, microstep):
+        self.time_us = time_us
+        self.microstep = microstep
+        # maps the fqn of each reaction executed at this tag to its execution
+        # time in microseconds
+        self.reactions = {}
+
+
+def tag_of(event):
+    return (event["args"]["timestamp_ns"], event["args"]["microstep"])
+
+
+def load_trace(path, graph):
+    with open(path) as f:
+        events = json.load(f)["traceEvents"]
+
+    # resolve the reactor and element names used for trigger events
+    processes = {}
+    threads = {}
+    for e in events:
+        if e.get("ph") == "M" and e["name"] == "process_name":
+            processes[e["pid"]] = e["args"]["name"]
+        elif e.get("ph") == "M" and e["name"] == "thread_name":
+            threads[(e["pid"], e["tid"])] = e["args"]["name"]
+
+    # Tag advances are only filtered by type and never sampled. If they are
+    # recorded, each execution is assigned to the tag that was current when
+    # it started. This allows to match triggers and executions even if some
+    # of them were dropped by sampling. Otherwise, the n-th trigger of a
+    # reaction is matched with its n-th execution.
+    advances = sorted((e["ts"], tag_of(e)) for e in events
+                      if e.get("name") == "tag advance")
+    advance_times = [a[0] for a in advances]
+    if not advances:
+        print("The trace does not contain tag advances. Triggers and "
+              "executions are matched by their order, which is only correct "
+              "if no events were dropped.", file=sys.stderr)
+
+    def current_tag(ts):
+        i = bisect.bisect_right(advance_times, ts) - 1
+        return advances[i][1] if i >= 0 else None
+
+    # collect execution times of each reaction, either by tag or in order of
+    # execution
+    durations = {}
+    open_executions = {}
+    executions = [e for e in events if e.get("cat") == "Execution" and
+                  e.get("ph") in ("B", "E")]
+    executions.sort(key=lambda e: e["ts"])
+    for e in executions:
+        key = (e["tid"], e["name"])
+        if e["ph"] == "B":
+            open_executions[key] = e["ts"]
+        elif key in open_executions:
+            start = open_executions.pop(key)
+            if advances:
+                durations[(e["name"], current_tag(start))] = e["ts"] - start
+            else:
+                durations.setdefault(e["name"], []).append(e["ts"] - start)
+
+    # collect the reactions triggered at each tag
+    triggers = [e for e in events if e.get("cat") == "Reactors" and
+                e["name"] == "trigger"]
+    triggers.sort(key=lambda e: (e["ts"], e["args"]["microstep"]))
+    tags = []
+    consumed = {}
+    for e in triggers:
+        reactor = processes.get(e["pid"])
+        reaction = threads.get((e["pid"], e["tid"]))
+        if reactor is None or reaction is None:
+            continue
+        fqn = reactor + "." + reaction
+        if fqn not in graph.index:
+            continue
+        if advances:
+            duration = durations.get((fqn, tag_of(e)))
+            if duration is None:
+                # the execution was not recorded
+                continue
+        else:
+            n = consumed.get(fqn, 0)
+            if n >= len(durations.get(fqn, [])):
+                continue
+            consumed[fqn] = n + 1
+            duration = durations[fqn][n]
+        microstep = e["args"]["microstep"]
+        if not tags or (tags[-1].time_us, tags[-1].microstep) != \
+                (e["ts"], microstep):
+            tags.append(TagExecution(e["ts"], microstep))
+        tags[-1].reactions[fqn] = duration
+
+    return tags
+
+
+class Result:
+    def __init__(self, makespans, lags, total):
+        self.mean = statistics.mean(makespans)
+        ordered = sorted(makespans)
+        self.p99 = ordered[min(len(ordered) - 1, int(len(ordered) * 0.99))]
+        self.max_lag = max(lags)
+        self.total = total
+        self.throughput = len(makespans) / total * 1e6 if total > 0 else 0
+
+
+def simulate(tags, graph, workers, policy, level_overhead, reaction_overhead):
+    makespans = []
+    lags = []
+    total = 0.0
+    # physical time at which the previous tag finished, relative to the
+    # logical time of the first tag
+    previous_finish = 0.0
+    origin = tags[0].time_us
+    for tag in tags:
+        if policy == "level":
+            makespan = simulate_levels(tag, graph, workers, level_overhead,
+                                       reaction_overhead)
+        else:
+            makespan = simulate_dag(tag, graph, workers, reaction_overhead)
+        makespans.append(makespan)
+        total += makespan
+        # in real-time execution, a tag cannot start before its logical time
+        start = max(tag.time_us - origin, previous_finish)
+        previous_finish = start + makespan
+        lags.append(previous_finish - (tag.time_us - origin))
+    return Result(makespans, lags, total)
+
+
+def list_schedule(durations, workers, start=0.0):
+    """Greedily assign the given durations to the earliest free worker."""
+    free = [start] * min(workers, len(durations))
+    heapq.heapify(free)
+    finish = start
+    for d in durations:
+        t = heapq.heappop(free) + d
+        finish = max(finish, t)
+        heapq.heappush(free, t)
+    return finish
+
+
+def simulate_levels(tag, graph, workers, level_overhead, reaction_overhead):
+    levels = {}
+    for fqn, duration in tag.reactions.items():
+        levels.setdefault(graph.index[fqn], []).append(
+            duration + reaction_overhead)
+    time = 0.0
+    for level in sorted(levels):
+        time = list_schedule(levels[level], workers, time) + level_overhead
+    return time
+
+
+def simulate_dag(tag, graph, workers, reaction_overhead):
+    # Reactions that were not triggered do not take any time, but still
+    # propagate the dependencies between triggered reactions.
+    finish = {}
+    order = sorted(graph.index, key=lambda fqn: graph.index[fqn])
+
+    # event driven simulation with a fixed number of workers, processing
+    # ready reactions in order of their index
+    free = [0.0] * workers
+    heapq.heapify(free)
+    pending = []
+    for fqn in order:
+        ready = max((finish[d] for d in graph.dependencies[fqn]), default=0.0)
+        if fqn not in tag.reactions:
+            finish[fqn] = ready
+            continue
+        pending.append(fqn)
+        # Assign the reaction to the worker that becomes free first. As
+        # reactions are visited in index order, a worker is never assigned
+        # a reaction before one of its dependencies.
+        worker = heapq.heappop(free)
+        start = max(worker, ready)
+        finish[fqn] = start + tag.reactions[fqn] + reaction_overhead
+        heapq.heappush(free, finish[fqn])
+    return max((finish[fqn] for fqn in pending), default=0.0)
+
+
+if(__name__ == "__main__"):
+    main()